@@ -50,6 +50,10 @@
 
 #include "task.h"
 
+#if ( configNUMBER_OF_CORES > 1 ) && ( XCHAL_CP_NUM > 0 )
+#include "asm-offsets.h"    /* TCB_END_OF_STACK_OFF */
+#endif
+
 /* Heap area (see heap_4.c). When MPU in use, align it to the MPU
    region boundary to avoid overlapping with non-heap data. */
 #if portUSING_MPU_WRAPPERS && configAPPLICATION_ALLOCATED_HEAP
@@ -366,6 +370,61 @@ static void xt_tick_timer_stop( void )
     xt_set_ccompare( XT_TIMER_INDEX, 0 );
 }
 
+#if ( configNUMBER_OF_CORES > 1 ) && ( XCHAL_CP_NUM > 0 )
+//-----------------------------------------------------------------------------
+// Coprocessor-owner core hint and cross-core CP migration counters. The
+// coprocessor exception handler records the owning core in each thread's CP
+// save area (XT_CP_CORE) and increments xt_cp_migrations[core] whenever it
+// restores state that was saved on another core.
+//-----------------------------------------------------------------------------
+volatile uint32_t xt_cp_migrations[ configNUMBER_OF_CORES ];
+
+BaseType_t xt_cp_core_hint( const void * cp_sa )
+{
+    uint32_t core;
+
+    if ( cp_sa == NULL )
+    {
+        return -1;
+    }
+
+    core = *( (const volatile uint16_t *) ( (const uint8_t *) cp_sa + XT_CP_CORE ) );
+    if ( ( core == 0U ) || ( core > configNUMBER_OF_CORES ) )
+    {
+        return -1;
+    }
+    return (BaseType_t) core - 1;
+}
+
+BaseType_t xPortGetCoprocCoreHint( TaskHandle_t xTask )
+{
+    // CP save area pointer is kept in pxEndOfStack, see pxPortInitialiseStack().
+    if ( xTask == NULL )
+    {
+        xTask = xTaskGetCurrentTaskHandle();
+    }
+    return xt_cp_core_hint( *( (void * const *) ( (const uint8_t *) xTask + TCB_END_OF_STACK_OFF ) ) );
+}
+
+uint32_t ulPortGetCoprocMigrations( BaseType_t xCoreID )
+{
+    uint32_t c;
+    uint32_t total = 0U;
+
+    if ( ( xCoreID >= 0 ) && ( xCoreID < configNUMBER_OF_CORES ) )
+    {
+        return xt_cp_migrations[ xCoreID ];
+    }
+
+    // Negative core ID returns the total over all cores
+    for ( c = 0; c < configNUMBER_OF_CORES; c++ )
+    {
+        total += xt_cp_migrations[ c ];
+    }
+    return total;
+}
+#endif
+
 #if ( configNUMBER_OF_CORES > 1 )
 //-----------------------------------------------------------------------------
 // IPI interrupts used for multicore scheduler
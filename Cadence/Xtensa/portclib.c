@@ -298,6 +298,74 @@ _reclaim_reent(struct _reent * ptr)
 //-----------------------------------------------------------------------------
 #if (defined __DYNAMIC_REENT__)
 
+  #if XT_USE_LAZY_CLIB_REENT && ( configUSE_C_RUNTIME_TLS_SUPPORT == 1 )
+
+//-----------------------------------------------------------------------------
+//  Lazily allocated per-task reentrancy blocks. A task's TLS slot stays NULL
+//  until its first C library call, when a block is taken from this pool.
+//  Tasks that never call the C library never own one. The pool must be sized
+//  for the number of tasks using the C library at any one time; if it runs
+//  out, the caller falls back to the shared block (and configASSERT fires).
+//-----------------------------------------------------------------------------
+static struct _reent xt_reent_pool[XT_CLIB_REENT_POOL_SIZE] __attribute__ ((aligned (16)));
+static uint8_t       xt_reent_pool_used[XT_CLIB_REENT_POOL_SIZE];
+
+static struct _reent *
+xt_reent_alloc(void)
+{
+    struct _reent * ptr = NULL;
+    uint32_t i;
+
+    taskENTER_CRITICAL();
+    for (i = 0; i < XT_CLIB_REENT_POOL_SIZE; i++) {
+        if (!xt_reent_pool_used[i]) {
+            xt_reent_pool_used[i] = 1;
+            ptr = &(xt_reent_pool[i]);
+            break;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    configASSERT(ptr != NULL);
+    if (ptr != NULL) {
+        _REENT_INIT_PTR(ptr);
+    }
+    return ptr;
+}
+
+//-----------------------------------------------------------------------------
+//  Return the running task's reent block, allocating it on first use. Never
+//  allocates from an interrupt handler (the C library must not be used there).
+//-----------------------------------------------------------------------------
+static inline struct _reent *
+xt_reent_get(struct _reent ** pp)
+{
+    if ((*pp == NULL) && (xPortIsInsideInterrupt() == pdFALSE)) {
+        *pp = xt_reent_alloc();
+    }
+    return *pp;
+}
+
+//-----------------------------------------------------------------------------
+//  Release a task's reent block, called via configDEINIT_TLS_BLOCK() when
+//  the task is deleted.
+//-----------------------------------------------------------------------------
+void
+vPortClibFreeReent(struct _reent * ptr)
+{
+    if (ptr != NULL) {
+        _reclaim_reent(ptr);
+
+        if ((ptr >= &(xt_reent_pool[0])) && (ptr < &(xt_reent_pool[XT_CLIB_REENT_POOL_SIZE]))) {
+            taskENTER_CRITICAL();
+            xt_reent_pool_used[ptr - &(xt_reent_pool[0])] = 0;
+            taskEXIT_CRITICAL();
+        }
+    }
+}
+
+  #endif /* XT_USE_LAZY_CLIB_REENT */
+
   #if (configNUMBER_OF_CORES > 1)
 
 struct _reent *
@@ -305,9 +373,18 @@ __getreent(void)
 {
     xt_internal_data_t *xt_intdata_p = &(_XT_INTDATA(portGET_CORE_ID()));
     #if ( configUSE_C_RUNTIME_TLS_SUPPORT == 1 )
+    #if XT_USE_LAZY_CLIB_REENT
+    if (xt_intdata_p->xt_reent_pp) {
+        struct _reent * ptr = xt_reent_get(xt_intdata_p->xt_reent_pp);
+        if (ptr) {
+            return ptr;
+        }
+    }
+    #else
     if (xt_intdata_p->xt_reent_p) {
         return xt_intdata_p->xt_reent_p;
     }
+    #endif /* XT_USE_LAZY_CLIB_REENT */
     #endif /* configUSE_C_RUNTIME_TLS_SUPPORT */
 
     // If TLS not configured or libc is used prior to starting the scheduler
@@ -324,9 +401,18 @@ struct _reent *
 __getreent(void)
 {
     #if ( configUSE_C_RUNTIME_TLS_SUPPORT == 1 )
+    #if XT_USE_LAZY_CLIB_REENT
+    if (_xt_intdata.xt_reent_pp) {
+        struct _reent * ptr = xt_reent_get(_xt_intdata.xt_reent_pp);
+        if (ptr) {
+            return ptr;
+        }
+    }
+    #else
     if (_xt_intdata.xt_reent_p) {
         return _xt_intdata.xt_reent_p;
     }
+    #endif /* XT_USE_LAZY_CLIB_REENT */
     #endif /* configUSE_C_RUNTIME_TLS_SUPPORT */
 
     // If TLS not configured or libc is used prior to starting the scheduler
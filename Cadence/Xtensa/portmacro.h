@@ -310,7 +310,11 @@ BaseType_t xPortRaisePrivilege( void );
         uint32_t xt_vpri_mask;
         uint32_t xt_core_init_done;
 #if (defined __DYNAMIC_REENT__)
+#if XT_USE_LAZY_CLIB_REENT
+        struct _reent **xt_reent_pp;        // Running task's lazily filled slot
+#else
         struct _reent *xt_reent_p;          // When xclib defines _reent_ptr()
+#endif
         void * xt_reent_pad_align;          // Ensure xt_reent is 16-byte aligned
         struct _reent xt_reent;
 #endif
@@ -375,6 +379,20 @@ BaseType_t xPortRaisePrivilege( void );
     #define portINCREMENT_INTERRUPT_NESTING_COUNT()   ( (_XT_INTDATA( portGET_CORE_ID() ).port_interruptNesting) ++ )
     #define portDECREMENT_INTERRUPT_NESTING_COUNT()   ( (_XT_INTDATA( portGET_CORE_ID() ).port_interruptNesting) -- )
 
+#if ( XCHAL_CP_NUM > 0 )
+    /* Coprocessor-owner core hint. Returns the core whose coprocessor registers
+     * last held the task's state, or -1 if unknown. A scheduler core-selection
+     * policy can prefer that core when several are eligible, avoiding a full
+     * CP save/restore across cores. portGET_COPROC_CORE_HINT takes a TCB_t
+     * pointer and is only usable where the TCB is visible (tasks.c); the hint
+     * is only meaningful once the task has run at least once.
+     */
+    extern BaseType_t xt_cp_core_hint( const void * cp_sa );
+    extern BaseType_t xPortGetCoprocCoreHint( struct tskTaskControlBlock * xTask );
+    extern uint32_t ulPortGetCoprocMigrations( BaseType_t xCoreID );
+    #define portGET_COPROC_CORE_HINT( pxTCB )   xt_cp_core_hint( ( pxTCB )->pxEndOfStack )
+#endif
+
     extern UBaseType_t vTaskEnterCriticalFromISR(void);
     extern void vTaskExitCriticalFromISR(UBaseType_t uxSavedInterruptStatus);
     #define portENTER_CRITICAL_FROM_ISR()   vTaskEnterCriticalFromISR()
@@ -392,7 +410,11 @@ BaseType_t xPortRaisePrivilege( void );
         uint32_t xt_intenable;
         uint32_t xt_vpri_mask;
 #if (defined __DYNAMIC_REENT__)
+#if XT_USE_LAZY_CLIB_REENT
+        struct _reent **xt_reent_pp;        // Running task's lazily filled slot
+#else
         struct _reent *xt_reent_p;          // When xclib defines _reent_ptr()
+#endif
 #endif
     } xt_internal_data_t;
 
@@ -79,6 +79,36 @@ extern xt_exc_handler xt_set_exception_handler( uint32_t n, xt_exc_handler f ) P
 extern xt_handler xt_set_interrupt_handler( uint32_t n, xt_handler f, void * arg ) PRIVILEGED_FUNCTION;
 
 
+/* Flags for xt_set_interrupt_handler_flags() */
+#define XT_INTR_FLAG_FAST       0x1U    /* Lightweight handler, bypasses the RTOS */
+
+/*
+-------------------------------------------------------------------------------
+  Call this function to set a handler for the specified interrupt, with flags.
+
+    n        - Interrupt number.
+    f        - Handler function address, NULL to uninstall handler.
+    arg      - Argument to be passed to handler.
+    flags    - Zero, or XT_INTR_FLAG_FAST.
+
+  With flags == 0 this is the same as xt_set_interrupt_handler().
+
+  XT_INTR_FLAG_FAST (requires XT_USE_FAST_INTR, XEA2 only) registers a
+  lightweight handler. It is called directly from the interrupt vector with
+  only the caller-saved registers saved, on the system interrupt stack, and
+  with all interrupts at or below XCHAL_EXCM_LEVEL masked. The RTOS is not
+  entered: the interrupt nesting count is not updated and no context switch
+  is performed on exit. Such a handler must therefore not call any FreeRTOS
+  API, and must not use coprocessors or other TIE state.
+
+  Returns NULL, leaving the current handler installed, if the fast flag is
+  requested but not supported, or if the interrupt is one used by the RTOS
+  for the tick or for scheduling, since those handlers request a yield.
+-------------------------------------------------------------------------------
+*/
+extern xt_handler xt_set_interrupt_handler_flags( uint32_t n, xt_handler f, void * arg, uint32_t flags ) PRIVILEGED_FUNCTION;
+
+
 /*
 -------------------------------------------------------------------------------
   Call this function to get a handler for the specified interrupt.
@@ -108,4 +108,21 @@
 #endif
     .endm
 
+/*
+*******************************************************************************
+* Macro to issue data-cache prefetches for 'size' bytes starting at the
+* address in register r, one DPFR per cache line plus one for the last word
+* in case r is not line-aligned. Only the first 1KB (the DPFR offset range)
+* is covered. Used by the dispatch paths when XT_USE_SWITCH_PREFETCH is set.
+*******************************************************************************
+*/
+    .macro  xt_prefetch r, size, off=0
+    .if ((\off) < (\size)) && ((\off) <= 1020)
+    dpfr    \r,  \off
+    xt_prefetch \r, \size, (\off + XCHAL_DCACHE_LINESIZE)
+    .elseif (((\size) - 4) <= 1020)
+    dpfr    \r,  ((\size) - 4)
+    .endif
+    .endm
+
 #endif /* XTENSA_ASM_H */
@@ -144,15 +144,50 @@
     #define XT_HAVE_THREAD_SAFE_CLIB        0
     #error The selected C runtime library is not thread safe.
   #endif    // XTHAL_CLIB_XCLIB || XTHAL_CLIB_NEWLIB
+  // XT_USE_LAZY_CLIB_REENT -- when nonzero, the TCB holds only a pointer and
+  // the _reent block is taken from a pool of XT_CLIB_REENT_POOL_SIZE entries
+  // by __getreent() on the task's first C library call (see portclib.c).
+  #ifndef XT_USE_LAZY_CLIB_REENT
+    #define XT_USE_LAZY_CLIB_REENT          0
+  #endif
+  #ifndef XT_CLIB_REENT_POOL_SIZE
+    #define XT_CLIB_REENT_POOL_SIZE         8
+  #endif
   #if (defined __DYNAMIC_REENT__)
     // For xclib/newlib with support for custom reent_ptr_() we keep
     // XT_CLIB_GLOBAL_PTR within interrupt data struct
+    #if XT_USE_LAZY_CLIB_REENT
+    // Keep a pointer to the running task's (possibly NULL) reent slot instead
+    // These are defaults only; a FreeRTOSConfig.h that sets them must keep
+    // the same pointer-sized block and free it with vPortClibFreeReent().
+    #ifndef configTLS_BLOCK_TYPE
+    #define configTLS_BLOCK_TYPE                            struct _reent *
+    #endif
+    #ifndef configINIT_TLS_BLOCK
+    #define configINIT_TLS_BLOCK(xTLSBlock, pxTopOfStack)   ( ( xTLSBlock ) = NULL )
+    #endif
+    #ifndef configDEINIT_TLS_BLOCK
+    #define configDEINIT_TLS_BLOCK(xTLSBlock)               vPortClibFreeReent( xTLSBlock )
+    #endif
+    #if (configNUMBER_OF_CORES > 1)
+    #define configSET_TLS_BLOCK(xTLSBlock)  ( _XT_INTDATA(portGET_CORE_ID()).xt_reent_pp = \
+                                                &( xTLSBlock ) )
+    #else
+    #define configSET_TLS_BLOCK(xTLSBlock)  ( _xt_intdata.xt_reent_pp = &( xTLSBlock ) )
+    #endif
+    #if !defined __ASSEMBLER__
+      void vPortClibFreeReent(struct _reent * ptr);
+    #endif  // !__ASSEMBLER__
+    #else   // XT_USE_LAZY_CLIB_REENT
     #if (configNUMBER_OF_CORES > 1)
     #define configSET_TLS_BLOCK(xTLSBlock)  ( _XT_INTDATA(portGET_CORE_ID()).xt_reent_p = \
                                                 &( xTLSBlock ) )
     #else
     #define configSET_TLS_BLOCK(xTLSBlock)  ( _xt_intdata.xt_reent_p = &( xTLSBlock ) )
     #endif
+    #endif  // XT_USE_LAZY_CLIB_REENT
+  #elif XT_USE_LAZY_CLIB_REENT
+    #error XT_USE_LAZY_CLIB_REENT requires a C library built with __DYNAMIC_REENT__.
   #endif // __DYNAMIC_REENT__
 #else
   #define XT_CLIB_CONTEXT_AREA_SIZE         0
@@ -249,6 +284,42 @@
     #define XT_DATARAM_ATTR       __attribute__ ((section(".dram0.data")))
 #endif
 
+/**
+ * XT_USE_SWITCH_PREFETCH can be enabled to issue data-cache prefetches for
+ * the incoming task as soon as vTaskSwitchContext() has selected it: the TCB
+ * line holding pxEndOfStack, the saved exception frame and the coprocessor
+ * save area header.  The misses then overlap with the remaining dispatch
+ * work instead of stalling the frame restore.  Most useful when task stacks
+ * are in cached system memory; has no effect without a data cache.
+ */
+#if (XCHAL_DCACHE_SIZE > 0)
+    #if !(defined XT_USE_SWITCH_PREFETCH)
+    #define XT_USE_SWITCH_PREFETCH    0
+    #endif
+#else
+    #undef  XT_USE_SWITCH_PREFETCH
+    #define XT_USE_SWITCH_PREFETCH    0
+#endif
+
+/**
+ * XT_USE_FAST_INTR can be enabled to allow interrupt handlers to be
+ * registered with XT_INTR_FLAG_FAST (see xt_set_interrupt_handler_flags()).
+ * Such handlers are dispatched directly from the level 1 and medium priority
+ * vectors with only the caller-saved registers saved, without entering the
+ * RTOS and without checking for a context switch on exit.  When enabled, all
+ * other interrupts at these levels pay a few extra cycles to check for pending
+ * fast interrupts.  Supported only for XEA2 with 32 or fewer interrupts, and
+ * not together with code overlays.
+ */
+#if XCHAL_HAVE_XEA2 && (XCHAL_NUM_INTERRUPTS <= 32) && !(defined XT_USE_OVLY)
+    #if !(defined XT_USE_FAST_INTR)
+    #define XT_USE_FAST_INTR          0
+    #endif
+#else
+    #undef  XT_USE_FAST_INTR
+    #define XT_USE_FAST_INTR          0
+#endif
+
 /* *INDENT-OFF* */
 #ifdef __cplusplus
     }
@@ -109,6 +109,22 @@
 
 #if XCHAL_HAVE_XEA2
 
+/*
+  Zero-overhead loop registers are saved in the frame unless XT_USE_LOOPS is
+  defined to 0. Do that only if no code in the application, including the C
+  library and any other prebuilt libraries, uses zero-overhead loops: LBEG,
+  LEND and LCOUNT are then neither saved nor restored on interrupt entry and
+  exit, which shrinks every frame (and so every task stack) by 12 bytes
+  before alignment. Interrupt hooks, software prioritization and overlay
+  support are likewise only included when XT_INTEXC_HOOKS, XT_USE_SWPRI and
+  XT_USE_OVLY are defined. (XEA3 frames are laid out by the dispatch code.)
+*/
+#if XCHAL_HAVE_LOOPS && !((defined XT_USE_LOOPS) && (XT_USE_LOOPS == 0))
+#define XT_STK_HAVE_LOOPS   1
+#else
+#define XT_STK_HAVE_LOOPS   0
+#endif
+
 XSTRUCT_BEGIN
 XSTRUCT_FIELD (long, 4, XT_STK_EXIT,     exit) /* exit point for dispatch */
 XSTRUCT_FIELD (long, 4, XT_STK_PC,       pc)   /* return PC */
@@ -132,7 +148,7 @@ XSTRUCT_FIELD (long, 4, XT_STK_A15,      a15)
 XSTRUCT_FIELD (long, 4, XT_STK_SAR,      sar)
 XSTRUCT_FIELD (long, 4, XT_STK_EXCCAUSE, exccause)
 XSTRUCT_FIELD (long, 4, XT_STK_EXCVADDR, excvaddr)
-#if XCHAL_HAVE_LOOPS
+#if XT_STK_HAVE_LOOPS
 XSTRUCT_FIELD (long, 4, XT_STK_LBEG,     lbeg)
 XSTRUCT_FIELD (long, 4, XT_STK_LEND,     lend)
 XSTRUCT_FIELD (long, 4, XT_STK_LCOUNT,   lcount)
@@ -322,6 +338,12 @@ XSTRUCT_END(XtExcFrame)
     Unsolicited switches will cause the entire coprocessor to be saved
     when necessary.
 
+  XT_CP_CORE
+    SMP only. One plus the index of the core whose coprocessor registers last
+    held this thread's state, or 0 if none. Set by the coprocessor exception
+    handler when it gives the thread ownership. Used as a core-selection hint
+    (see portGET_COPROC_CORE_HINT) and to count cross-core CP migrations.
+
   XT_CP_ASA
     Pointer to the aligned save area.  Allows it to be aligned more than
     the overall save area (which might only be stack-aligned or TCB-aligned).
@@ -347,6 +369,7 @@ XSTRUCT_END(XtExcFrame)
 #define XT_CPENABLE 0   /* (2 bytes) coprocessors active for this thread */
 #define XT_CPSTORED 2   /* (2 bytes) coprocessors saved for this thread */
 #define XT_CP_CS_ST 4   /* (2 bytes) coprocessor callee-saved regs stored for this thread */
+#define XT_CP_CORE  6   /* (2 bytes) core + 1 that last owned this thread's CP state (SMP) */
 #define XT_CP_ASA   8   /* (4 bytes) ptr to aligned save area */
 /*  Overall size allows for dynamic alignment:  */
 #define XT_CP_SIZE  (12 + XT_CP_SA_SIZE + XCHAL_TOTAL_SA_ALIGN)
@@ -532,6 +555,11 @@ XSTRUCT_END(XtExcFrame)
     pxctcb   a9,  a10                           // pxCurrentTCB or pxCurrentTCBs[]
     l32i     a9,  a9, 0                         // a9 <- pxCurrentTCB
 
+#if XT_USE_SWITCH_PREFETCH
+    l32i    a10,  a9, TCB_TOP_OF_STACK_OFF      // start fetching saved frame
+    xt_prefetch a10, XT_STK_FRMSZ
+#endif
+
 #if XCHAL_CP_NUM > 0
     l32i    a10,  a9, TCB_END_OF_STACK_OFF
     l16ui   a10,  a10, XT_CPENABLE
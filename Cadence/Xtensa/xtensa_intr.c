@@ -138,6 +138,44 @@ xt_unhandled_interrupt( void * arg )
 }
 
 
+#if XT_USE_FAST_INTR
+/* Mask of interrupts with lightweight handlers, in xtensa_intr_asm.S */
+extern volatile uint32_t _xt_fast_intmask;
+
+#if ( configNUMBER_OF_CORES > 1 )
+/* Scheduler IPIs, in port.c */
+extern const uint32_t xt_ipi_intnum[configNUMBER_OF_CORES];
+#endif
+
+/*
+  Returns nonzero if interrupt n is used by the RTOS itself. The handlers
+  for these request a context switch, so they cannot bypass the RTOS.
+*/
+static int32_t
+xt_is_rtos_interrupt( uint32_t n )
+{
+#if ( configNUMBER_OF_CORES > 1 )
+    int32_t c;
+
+    for ( c = 0; c < configNUMBER_OF_CORES; c++ )
+    {
+        if ( n == xt_ipi_intnum[c] )
+        {
+            return 1;
+        }
+    }
+#endif
+#ifdef XT_TIMER_INTNUM
+    if ( n == (uint32_t) XT_TIMER_INTNUM )
+    {
+        return 1;
+    }
+#endif
+    return 0;
+}
+#endif
+
+
 /*
   This function registers a handler for the specified interrupt. The "arg"
   parameter specifies the argument to be passed to the handler when it is
@@ -147,9 +185,26 @@ xt_unhandled_interrupt( void * arg )
 */
 xt_handler
 xt_set_interrupt_handler( uint32_t n, xt_handler f, void * arg )
+{
+    return xt_set_interrupt_handler_flags( n, f, arg, 0 );
+}
+
+
+/*
+  Same as xt_set_interrupt_handler(), with flags. If XT_INTR_FLAG_FAST is
+  set, the handler is dispatched directly by the vector code (see the
+  dispatch_fast_isr macro in xtensa_vectors.S). Interrupts the RTOS uses
+  for scheduling are rejected, as are fast handlers when XT_USE_FAST_INTR
+  is not enabled. On error, it returns NULL.
+*/
+xt_handler
+xt_set_interrupt_handler_flags( uint32_t n, xt_handler f, void * arg, uint32_t flags )
 {
     xt_handler_table_entry * entry;
     xt_handler               old;
+#if XT_USE_FAST_INTR
+    int                      ps;
+#endif
 
     if ( n >= (uint32_t) XCHAL_NUM_INTERRUPTS )
     {
@@ -165,6 +220,20 @@ xt_set_interrupt_handler( uint32_t n, xt_handler f, void * arg )
     }
 #endif
 
+#if XT_USE_FAST_INTR
+    if ( ( ( flags & XT_INTR_FLAG_FAST ) != 0U ) && ( xt_is_rtos_interrupt( n ) != 0 ) )
+    {
+        // RTOS interrupts must go through the RTOS.
+        return NULL;
+    }
+#else
+    if ( ( flags & XT_INTR_FLAG_FAST ) != 0U )
+    {
+        // Fast dispatch not supported in this build.
+        return NULL;
+    }
+#endif
+
 #if (XT_USE_INT_WRAPPER || XCHAL_HAVE_XEA3)
     entry = _xt_interrupt_table + n + 1;
 #else
@@ -172,6 +241,12 @@ xt_set_interrupt_handler( uint32_t n, xt_handler f, void * arg )
 #endif
     old   = entry->handler;
 
+#if XT_USE_FAST_INTR
+    // Take the interrupt off the fast path while the entry is updated.
+    ps = XT_RSIL( 15 );
+    _xt_fast_intmask &= ~( 1U << n );
+#endif
+
     if ( f != NULL )
     {
         entry->handler = f;
@@ -183,6 +258,15 @@ xt_set_interrupt_handler( uint32_t n, xt_handler f, void * arg )
         entry->arg     = (void*)n;
     }
 
+#if XT_USE_FAST_INTR
+    if ( ( f != NULL ) && ( ( flags & XT_INTR_FLAG_FAST ) != 0U ) )
+    {
+        _xt_fast_intmask |= ( 1U << n );
+    }
+    XT_WSR_PS( ps );
+    XT_RSYNC();
+#endif
+
     return old;
 }
 
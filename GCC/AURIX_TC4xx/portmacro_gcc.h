@@ -55,6 +55,7 @@
 #define portCPU_ICR_CCPN_OFF     ( 0 )
 #define portCPU_ICR_CCPN_MSK     ( 0x000000FFUL )
 #define portCPU_FCX              0xFE38
+#define portCPU_LCX              0xFE3C
 #define portCPU_PCXI             0xFE00
 #define portCPU_CORE_ID          0xFE1C
 
@@ -160,6 +161,42 @@ extern void vPortExitCritical( void );
 extern void vPortReclaimCSA( unsigned long ** pxTCB );
 #define portCLEAN_UP_TCB( pxTCB )    vPortReclaimCSA( ( unsigned long ** ) ( pxTCB ) )
 
+/* CSA pool accounting.
+ * configUSE_PORT_CSA_ACCOUNTING: set to 1 to provide uxPortGetFreeCSACount(),
+ * uxPortGetMinimumEverFreeCSACount() and uxPortGetTaskCSACount() (NULL for
+ * the calling task). The counts stop at LCX, so the CSAs kept for the
+ * depletion trap handler are not included. Defaults to 0.
+ * configPORT_CSA_LOW_THRESHOLD: when non-zero, the free list is sampled on
+ * every tick and vApplicationCSALowHook() is called once each time fewer than
+ * this many CSAs are left before LCX. The hook runs with interrupts disabled,
+ * or in the tick interrupt with the mask at
+ * configMAX_API_CALL_INTERRUPT_PRIORITY, so it must not block and may only
+ * call FromISR API functions. Defaults to 0.
+ * configPORT_CSA_TASK_BUDGET: CSAs every task is expected to need for its call
+ * stack. Task creation asserts that at least this many remain free. Defaults
+ * to 0. */
+#ifndef configUSE_PORT_CSA_ACCOUNTING
+    #define configUSE_PORT_CSA_ACCOUNTING    0
+#endif
+
+#if ( configUSE_PORT_CSA_ACCOUNTING != 0 )
+    #ifndef configPORT_CSA_LOW_THRESHOLD
+        #define configPORT_CSA_LOW_THRESHOLD    0
+    #endif
+
+    #ifndef configPORT_CSA_TASK_BUDGET
+        #define configPORT_CSA_TASK_BUDGET    0
+    #endif
+
+    extern UBaseType_t uxPortGetFreeCSACount( void );
+    extern UBaseType_t uxPortGetMinimumEverFreeCSACount( void );
+    extern UBaseType_t uxPortGetTaskCSACount( void * xTask );
+
+    #if ( configPORT_CSA_LOW_THRESHOLD > 0 )
+        extern void vApplicationCSALowHook( UBaseType_t uxFreeCSAs );
+    #endif
+#endif /* configUSE_PORT_CSA_ACCOUNTING */
+
 
 /* ICR & CCPN modifying functions to enable and disable interrupts.
  * Only interrupts with a priority lower than
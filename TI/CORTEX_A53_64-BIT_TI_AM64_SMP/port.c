@@ -59,6 +59,8 @@
 
 /* Standard includes. */
 #include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
 
 /* Scheduler includes. */
 #include "FreeRTOS.h"
@@ -74,10 +76,6 @@
 	#endif
 #endif /* configUSE_PORT_OPTIMISED_TASK_SELECTION */
 
-/* A critical section is exited when the critical section nesting count reaches
-this value. */
-#define portNO_CRITICAL_NESTING			( ( size_t ) 0 )
-
 /* Tasks are not created with a floating point context, but can be given a
 floating point context after they have been created.  A variable is stored as
 part of the tasks context that holds portNO_FLOATING_POINT_CONTEXT if the task
@@ -99,28 +97,189 @@ context. */
  */
 extern void vPortRestoreTaskContext( void );
 
-/* Saved as part of the task context.  If ullPortTaskHasFPUContext is non-zero
-then floating point context must be saved and restored for the task. */
-volatile uint64_t ullPortTaskHasFPUContext[configNUM_CORES] = {pdFALSE};
+/* Per-core port state, see portmacro.h.  ullTaskHasFPUContext is saved as
+part of the task context: if it is non-zero then floating point context must
+be saved and restored for the task.  A context switch is only performed if
+ullInterruptNesting is 0. */
+PortCoreData_t xPortCoreData[configNUMBER_OF_CORES];
 
-/* Set to 1 to pend a context switch from an ISR. */
-uint64_t ullPortYieldRequired[configNUM_CORES] = { pdFALSE };
+/* portASM.S relies on these. */
+_Static_assert( offsetof( PortCoreData_t, ullYieldRequired ) == portCORE_DATA_YIELD_REQUIRED_OFFSET, "portASM.S offset mismatch" );
+_Static_assert( offsetof( PortCoreData_t, ullInterruptNesting ) == portCORE_DATA_INTERRUPT_NESTING_OFFSET, "portASM.S offset mismatch" );
+_Static_assert( offsetof( PortCoreData_t, ullTaskHasFPUContext ) == portCORE_DATA_FPU_CONTEXT_OFFSET, "portASM.S offset mismatch" );
+_Static_assert( offsetof( PortCoreData_t, ullCoreIndex ) == portCORE_DATA_CORE_INDEX_OFFSET, "portASM.S offset mismatch" );
+_Static_assert( offsetof( PortCoreData_t, ullFPUSaveArea ) == portCORE_DATA_FPU_SAVE_AREA_OFFSET, "portASM.S offset mismatch" );
+_Static_assert( offsetof( PortCoreData_t, ullPMUData ) == portCORE_DATA_PMU_DATA_OFFSET, "portASM.S offset mismatch" );
+_Static_assert( sizeof( PortCoreData_t ) == portCACHE_LINE_SIZE, "PortCoreData_t must be one cache line" );
 
-/* Counts the interrupt nesting depth.  A context switch is only performed if
-if the nesting depth is 0. */
-uint64_t ullPortInterruptNesting[configNUM_CORES] = { 0 };
+/* Kernel ISR and task locks, each on its own cache line, see
+vPortRecursiveLock(). */
+PortRecursiveLock_t xPortLocks[ portRTOS_LOCK_COUNT ];
 
 /* flag to control tick ISR handling, this is made true just before schedular start */
 volatile uint64_t ullPortSchedularRunning = pdFALSE;
 
-#define portPRIORITY_SHIFT 4
-__attribute__(( used )) const uint64_t ullMaxAPIPriorityMask = ( configMAX_API_CALL_INTERRUPT_PRIORITY << portPRIORITY_SHIFT );
+#if ( configUSE_GENERIC_TIMER_TICK == 1 )
+
+	/* CNTV_CTL_EL0.ENABLE, with IMASK clear. */
+	#define portGENERIC_TIMER_ENABLE	( 1ULL )
+
+	static HwiP_Object xTickHwiObject;
+
+	/* Counter ticks per RTOS tick, and the counter value at which the next RTOS
+	tick is due.  The compare value is always programmed as an absolute
+	deadline, so interrupt latency never accumulates as tick drift. */
+	static uint64_t ullTimerCountsForOneTick;
+	static volatile uint64_t ullNextTickCompare;
+
+	static void prvSetupGenericTimerTick( void );
+	static void prvGenericTimerTickISR( void *pvArgs );
+
+	#if ( configUSE_TICKLESS_IDLE != 0 )
+		/* Tickless sleeps taken, and tick interrupts they avoided, see
+		vPortGetTicklessStats(). */
+		static uint64_t ullTicklessSleeps;
+		static uint64_t ullTicklessTicksSuppressed;
+	#endif
+
+#endif /* configUSE_GENERIC_TIMER_TICK */
+
+__attribute__(( used )) const uint64_t ullMaxAPIPriorityMask = portMAX_API_PRIORITY_MASK;
+
+#if ( configUSE_PORT_PMU_TRACE == 1 )
+
+	/* PMCR_EL0: E (enable), C (reset cycle counter), LC (64-bit overflow). */
+	#define portPMCR_E_C_LC				( ( 1ULL << 0 ) | ( 1ULL << 2 ) | ( 1ULL << 6 ) )
+	/* PMCNTENSET_EL0.C */
+	#define portPMCNTENSET_C			( 1ULL << 31 )
+
+	typedef struct xPORT_PMU_DATA
+	{
+		/* Written by portASM.S. */
+		volatile uint64_t ullStampIrqEntry;
+		volatile uint64_t ullStampSwitchStart;
+		volatile uint64_t ullStampSwitchDone;
+
+		/* End of the last portSAVE_CONTEXT, whose restore phase is closed by
+		ullStampSwitchDone. */
+		uint64_t ullSwitchSaved;
+
+		PortPMUPhaseStats_t xPhase[ portPMU_PHASE_COUNT ];
+	} PortPMUData_t;
+
+	_Static_assert( offsetof( PortPMUData_t, ullStampIrqEntry ) == portPMU_STAMP_IRQ_ENTRY_OFFSET, "portASM.S offset mismatch" );
+	_Static_assert( offsetof( PortPMUData_t, ullStampSwitchStart ) == portPMU_STAMP_SWITCH_START_OFFSET, "portASM.S offset mismatch" );
+	_Static_assert( offsetof( PortPMUData_t, ullStampSwitchDone ) == portPMU_STAMP_SWITCH_DONE_OFFSET, "portASM.S offset mismatch" );
+
+	static PortPMUData_t xPortPMUData[ configNUMBER_OF_CORES ];
+
+	static void prvPMUInit( PortCoreData_t *pxCoreData );
+
+#endif /* configUSE_PORT_PMU_TRACE */
+
+#if ( configUSE_PORT_MAILBOX == 1 )
+	#if ( configPORT_MAILBOX_NOTIFY_INDEX >= configTASK_NOTIFICATION_ARRAY_ENTRIES )
+		#error configPORT_MAILBOX_NOTIFY_INDEX must be less than configTASK_NOTIFICATION_ARRAY_ENTRIES.
+	#endif
+
+	static void prvSetupMailboxDoorbell( void );
+#endif
+
+#if ( configUSE_PORT_LOAD_ACCOUNTING == 1 )
+
+	/* Owned by one core; other cores read it under ulSequence, which is odd
+	while an update is in progress. */
+	typedef struct xPORT_LOAD_DATA
+	{
+		volatile uint32_t ulSequence;
+		volatile uint32_t ulState;
+		volatile uint64_t ullTimestamp;				/* Counter value at the last transition. */
+		volatile uint64_t ullCounts[ portLOAD_STATE_COUNT ];
+	} __attribute__( ( aligned( portCACHE_LINE_SIZE ) ) ) PortLoadData_t;
+
+	static PortLoadData_t xPortLoadData[ configNUMBER_OF_CORES ];
+
+	static void prvLoadInit( void );
+	static void prvLoadEnterState( uint32_t ulState );
+
+#endif /* configUSE_PORT_LOAD_ACCOUNTING */
+
+#if ( configUSE_PORT_EXC_STACK_MONITOR == 1 )
+
+	#define portEXC_STACK_FILL			( 0xa5a5a5a5a5a5a5a5ULL )
+
+	/* Keep the area just below the live SP_EL1 unpainted, it is about to be
+	used by whatever called vPortSetExceptionStack(). */
+	#define portEXC_STACK_PAINT_MARGIN	( 64U )
+
+	typedef struct xPORT_EXC_STACK
+	{
+		uint64_t *pullBase;					/* Lowest address of the stack. */
+		uint64_t *pullLowestUsed;			/* Lowest word seen in use by a scan. */
+	} PortExcStack_t;
+
+	static PortExcStack_t xPortExcStacks[ configNUMBER_OF_CORES ];
+
+#endif /* configUSE_PORT_EXC_STACK_MONITOR */
+
+static inline uint64_t prvReadCounter( void );
+static uint64_t prvCounterToUsecs( uint64_t ullCount );
+static void prvIdleWaitForInterrupt( void );
+
+void vPortInitCoreData( void )
+{
+    BaseType_t xCoreID = portGET_CORE_ID();
+    PortCoreData_t *pxCoreData;
+
+    /* The index is only dense if every cluster has 1 << portCLUSTER_CORE_SHIFT
+    cores, see portmacro.h.  Anything else would index past the per-core
+    arrays. */
+    configASSERT( ( xCoreID >= 0 ) && ( xCoreID < configNUMBER_OF_CORES ) );
+
+    pxCoreData = &xPortCoreData[ xCoreID ];
+    pxCoreData->ullCoreIndex = ( uint64_t ) xCoreID;
+
+    #if ( configUSE_PORT_PMU_TRACE == 1 )
+    {
+        if( pxCoreData->ullPMUData == 0 )
+        {
+            prvPMUInit( pxCoreData );
+        }
+    }
+    #endif
+
+    __asm volatile ( "MSR TPIDR_EL1, %0" :: "r" ( pxCoreData ) : "memory" );
+}
 
 /*
  * See header file for description.
  */
 StackType_t *pxPortInitialiseStack( StackType_t *pxTopOfStack, TaskFunction_t pxCode, void *pvParameters )
 {
+	#if ( portTLS_BLOCK_IN_STACK == 1 )
+		/* configINIT_TLS_BLOCK() left the task's TLS block at the top of the
+		stack, see pxPortInitTLSBlock(). */
+		StackType_t xThreadPointer = ( StackType_t ) pxTopOfStack;
+	#else
+		StackType_t xThreadPointer = 0;
+	#endif
+
+	#if ( configUSE_TASK_FPU_SUPPORT == 2 )
+		StackType_t *pxFPUSaveArea;
+		size_t x;
+
+		/* Reserve the task's FPU save area at the top of its stack.  It starts
+		zeroed, so the task's first floating point instruction sees cleared
+		registers and the default FPCR. */
+		pxTopOfStack -= portFPU_SAVE_AREA_SIZE / sizeof( StackType_t );
+		pxFPUSaveArea = pxTopOfStack;
+
+		for( x = 0; x < ( portFPU_SAVE_AREA_SIZE / sizeof( StackType_t ) ); x++ )
+		{
+			pxFPUSaveArea[ x ] = 0;
+		}
+	#endif
+
 	/* Setup the initial stack of the task.  The stack is set exactly as
 	expected by the portRESTORE_CONTEXT() macro. */
 
@@ -186,7 +345,7 @@ StackType_t *pxPortInitialiseStack( StackType_t *pxTopOfStack, TaskFunction_t px
 	pxTopOfStack--;
 	*pxTopOfStack = 0x2828282828282828ULL;	/* R28 */
 	pxTopOfStack--;
-	*pxTopOfStack = ( StackType_t ) 0x00;	/* XZR - has no effect, used so there are an even number of registers. */
+	*pxTopOfStack = xThreadPointer;			/* TPIDR_EL0, in the pad slot that pairs with R30. */
 	pxTopOfStack--;
 	*pxTopOfStack = ( StackType_t ) 0x00;	/* R30 - procedure call link register. */
 	pxTopOfStack--;
@@ -197,15 +356,20 @@ StackType_t *pxPortInitialiseStack( StackType_t *pxTopOfStack, TaskFunction_t px
 	*pxTopOfStack = ( StackType_t ) pxCode; /* Exception return address. */
 	pxTopOfStack--;
 
-	/* The task will start with a critical nesting count of 0 as interrupts are
-	enabled. */
-	*pxTopOfStack = portNO_CRITICAL_NESTING;
+	/* The task will start with no interrupts masked in ICC_PMR_EL1. */
+	*pxTopOfStack = portUNMASK_VALUE;
 	pxTopOfStack--;
 
-	/* The task will start without a floating point context.  A task that uses
-	the floating point hardware must call vPortTaskUsesFPU() before executing
-	any floating point instructions. */
-	*pxTopOfStack = portNO_FLOATING_POINT_CONTEXT;
+	#if ( configUSE_TASK_FPU_SUPPORT == 2 )
+		/* With lazy FPU switching this slot holds the address of the task's
+		FPU save area instead. */
+		*pxTopOfStack = ( StackType_t ) pxFPUSaveArea;
+	#else
+		/* The task will start without a floating point context.  A task that
+		uses the floating point hardware must call vPortTaskUsesFPU() before
+		executing any floating point instructions. */
+		*pxTopOfStack = portNO_FLOATING_POINT_CONTEXT;
+	#endif
 
 	return pxTopOfStack;
 }
@@ -226,10 +390,37 @@ BaseType_t xPortStartScheduler( void )
 		executing. */
 		portDISABLE_INTERRUPTS();
 
+        /* The tick and mailbox interrupts are installed at this priority and
+        call the API.  The yield SGI is installed by the DPL, its priority is
+        checked by portEND_SWITCHING_ISR() the first time it is taken. */
+        configASSERT( configKERNEL_INTERRUPT_PRIORITY >= configMAX_API_CALL_INTERRUPT_PRIORITY );
+        configASSERT( configKERNEL_INTERRUPT_PRIORITY < HwiP_MAX_PRIORITY );
+
         if (0 == portGET_CORE_ID())
         {
             ullPortSchedularRunning = pdTRUE;
+
+            #if ( configUSE_GENERIC_TIMER_TICK == 1 )
+            {
+                prvSetupGenericTimerTick();
+            }
+            #endif
+        }
+
+        /* Point TPIDR_EL1 at this core's data before the first task runs. */
+        vPortInitCoreData();
+
+        #if ( configUSE_PORT_LOAD_ACCOUNTING == 1 )
+        {
+            prvLoadInit();
+        }
+        #endif
+
+        #if ( configUSE_PORT_MAILBOX == 1 )
+        {
+            prvSetupMailboxDoorbell();
         }
+        #endif
 
 		/* Start the first task executing. */
 		vPortRestoreTaskContext();
@@ -245,26 +436,201 @@ void vPortEndScheduler( void )
 	configASSERT( 0 );
 }
 
-void vPortTimerTickHandler()
+static void prvTickHandler( void )
 {
+    PortCoreData_t *pxCoreData = &xPortCoreData[ portGET_CORE_ID() ];
+
     if( ullPortSchedularRunning == pdTRUE )
     {
+        /* One tick can ready tasks for several cores, so collect the yield
+        requests for other cores and send them together. */
+        pxCoreData->ullYieldBatching = pdTRUE;
+
         /* Increment the RTOS tick. */
         if( xTaskIncrementTick() != pdFALSE )
         {
-            ullPortYieldRequired[portGET_CORE_ID()] = pdTRUE;
+            pxCoreData->ullYieldRequired = pdTRUE;
+        }
+
+        pxCoreData->ullYieldBatching = pdFALSE;
+
+        if( pxCoreData->ullYieldBatchMask != 0 )
+        {
+            vPortYieldCores( pxCoreData->ullYieldBatchMask );
+            pxCoreData->ullYieldBatchMask = 0;
         }
     }
 }
 
+void vPortTimerTickHandler()
+{
+    #if ( configUSE_GENERIC_TIMER_TICK == 0 )
+    {
+        prvTickHandler();
+    }
+    #endif
+}
+
+#if ( configUSE_GENERIC_TIMER_TICK == 1 )
+
+static inline uint64_t prvReadGenericCounter( void )
+{
+    uint64_t ullCount;
+
+    __asm volatile ( "ISB SY\n\tMRS %0, CNTVCT_EL0" : "=r" ( ullCount ) :: "memory" );
+
+    return ullCount;
+}
+
+static inline void prvSetGenericTimerCompare( uint64_t ullCompare )
+{
+    __asm volatile ( "MSR CNTV_CVAL_EL0, %0\n\tISB SY" :: "r" ( ullCompare ) : "memory" );
+}
+
+static void prvSetupGenericTimerTick( void )
+{
+    HwiP_Params xHwiParams;
+    uint64_t ullFrequency;
+
+    __asm volatile ( "MRS %0, CNTFRQ_EL0" : "=r" ( ullFrequency ) );
+    configASSERT( ullFrequency >= configTICK_RATE_HZ );
+
+    ullTimerCountsForOneTick = ullFrequency / configTICK_RATE_HZ;
+    ullNextTickCompare = prvReadGenericCounter() + ullTimerCountsForOneTick;
+    prvSetGenericTimerCompare( ullNextTickCompare );
+
+    HwiP_Params_init( &xHwiParams );
+    xHwiParams.intNum = configGENERIC_TIMER_INTR_NUM;
+    xHwiParams.callback = prvGenericTimerTickISR;
+    xHwiParams.priority = configKERNEL_INTERRUPT_PRIORITY;
+    xHwiParams.isPulse = 0;
+    ( void ) HwiP_construct( &xTickHwiObject, &xHwiParams );
+
+    __asm volatile ( "MSR CNTV_CTL_EL0, %0\n\tISB SY" :: "r" ( portGENERIC_TIMER_ENABLE ) : "memory" );
+}
+
+static void prvGenericTimerTickISR( void *pvArgs )
+{
+    ( void ) pvArgs;
+
+    /* Move the deadline on by one tick.  The timer interrupt is level
+    sensitive, so if more than one tick was missed the interrupt is still
+    asserted and the ticks are caught up one at a time. */
+    ullNextTickCompare += ullTimerCountsForOneTick;
+    prvSetGenericTimerCompare( ullNextTickCompare );
+
+    prvTickHandler();
+}
+
+#if ( configUSE_TICKLESS_IDLE != 0 )
+
+void vPortSuppressTicksAndSleep( TickType_t xExpectedIdleTime )
+{
+    uint64_t ullLastTick, ullWakeCompare, ullNow, ullCompletedTicks;
+    uintptr_t xInterruptState;
+    TickType_t xModifiableIdleTime;
+
+    xInterruptState = HwiP_disable();
+
+    /* A context switch may be pending, or a task made ready, since the
+    idle task decided to sleep. */
+    if( eTaskConfirmSleepModeStatus() == eAbortSleep )
+    {
+        HwiP_restore( xInterruptState );
+        return;
+    }
+
+    /* Sleep until xExpectedIdleTime ticks after the last tick.  The compare
+    register is 64-bit so there is no limit on how far ahead that can be. */
+    ullLastTick = ullNextTickCompare - ullTimerCountsForOneTick;
+    ullWakeCompare = ullLastTick + ( ( uint64_t ) xExpectedIdleTime * ullTimerCountsForOneTick );
+    prvSetGenericTimerCompare( ullWakeCompare );
+
+    xModifiableIdleTime = xExpectedIdleTime;
+    configPRE_SLEEP_PROCESSING( xModifiableIdleTime );
+    if( xModifiableIdleTime > 0 )
+    {
+        #if ( configUSE_PORT_LOAD_ACCOUNTING == 1 )
+        {
+            prvLoadEnterState( portLOAD_STATE_WFI );
+        }
+        #endif
+
+        __asm volatile ( "DSB SY\n\tWFI\n\tISB SY" ::: "memory" );
+        ullTicklessSleeps++;
+
+        #if ( configUSE_PORT_LOAD_ACCOUNTING == 1 )
+        {
+            prvLoadEnterState( portLOAD_STATE_TASK );
+        }
+        #endif
+    }
+    configPOST_SLEEP_PROCESSING( xExpectedIdleTime );
+
+    /* Work out how many whole ticks passed from the counter itself. */
+    ullNow = prvReadGenericCounter();
+    ullCompletedTicks = ( ullNow - ullLastTick ) / ullTimerCountsForOneTick;
+
+    if( ullCompletedTicks >= xExpectedIdleTime )
+    {
+        /* The timer expired.  Leave its compare value in place so the tick
+        interrupt runs as soon as interrupts are enabled and accounts for the
+        last tick itself, unblocking whatever task is due. */
+        ullCompletedTicks = xExpectedIdleTime - 1;
+        ullNextTickCompare = ullWakeCompare;
+    }
+    else
+    {
+        /* Woken early by another interrupt.  Put the tick back on the
+        boundary following the current time. */
+        ullNextTickCompare = ullLastTick + ( ( ullCompletedTicks + 1 ) * ullTimerCountsForOneTick );
+        prvSetGenericTimerCompare( ullNextTickCompare );
+    }
+
+    vTaskStepTick( ( TickType_t ) ullCompletedTicks );
+    ullTicklessTicksSuppressed += ullCompletedTicks;
+
+    HwiP_restore( xInterruptState );
+}
+
+void vPortGetTicklessStats( uint64_t *pullSleeps, uint64_t *pullTicksSuppressed )
+{
+    uintptr_t xInterruptState = HwiP_disable();
+
+    *pullSleeps = ullTicklessSleeps;
+    *pullTicksSuppressed = ullTicklessTicksSuppressed;
+
+    HwiP_restore( xInterruptState );
+}
+
+#endif /* configUSE_TICKLESS_IDLE */
+
+#endif /* configUSE_GENERIC_TIMER_TICK */
+
+#if ( configUSE_TASK_FPU_SUPPORT == 2 )
+
+/* Called from HwiP_Sync_Handler in portASM.S when an interrupt handler or the
+kernel executes an FP/SIMD instruction while a task owns the FPU registers. */
+void vPortFPUAccessFromHandler( uint64_t ullAddress )
+{
+    DebugP_logError( "[FreeRTOS] FP/SIMD access from handler mode on core %d at 0x%llx, build kernel and ISR code with -mgeneral-regs-only", ( int ) portGET_CORE_ID(), ( unsigned long long ) ullAddress );
+    DebugP_assertNoLog( 0 );
+}
+
+#endif /* configUSE_TASK_FPU_SUPPORT */
+
 void vPortTaskUsesFPU( void )
 {
-	/* A task is registering the fact that it needs an FPU context.  Set the
-	FPU flag (which is saved as part of the task context). */
-	ullPortTaskHasFPUContext[portGET_CORE_ID()] = pdTRUE;
+	#if ( configUSE_TASK_FPU_SUPPORT == 2 )
+		/* Every task has an FPU context, which is switched in on first use. */
+	#else
+		/* A task is registering the fact that it needs an FPU context.  Set the
+		FPU flag (which is saved as part of the task context). */
+		xPortCoreData[portGET_CORE_ID()].ullTaskHasFPUContext = pdTRUE;
 
-	/* Consider initialising the FPSR here - but probably not necessary in
-	AArch64. */
+		/* Consider initialising the FPSR here - but probably not necessary in
+		AArch64. */
+	#endif
 }
 
 /* configCHECK_FOR_STACK_OVERFLOW is set to 1, so the application must provide an
@@ -277,6 +643,138 @@ void vApplicationStackOverflowHook( TaskHandle_t xTask,
     DebugP_assertNoLog(0);
 }
 
+#if ( portTLS_BLOCK_IN_STACK == 1 )
+
+/* Bounds of the static TLS block, from the linker script. */
+extern const uint8_t __tls_start[], __tdata_end[], __tls_end[], __tls_align[];
+
+/* TPIDR_EL0 points at a TCB of this size, which the TLS block follows at its
+own alignment. */
+#define portTLS_TCB_SIZE	( 16U )
+
+StackType_t *pxPortInitTLSBlock( void **ppvTLSBlock, StackType_t *pxTopOfStack )
+{
+    uintptr_t xAlign = ( uintptr_t ) __tls_align;
+    uintptr_t xBlock;
+    size_t xSize;
+
+    /* The TCB size is a power of two, so the block starts xAlign above the
+    thread pointer once xAlign is at least the TCB size, which also keeps the
+    stack aligned. */
+    if( xAlign < portTLS_TCB_SIZE )
+    {
+        xAlign = portTLS_TCB_SIZE;
+    }
+
+    xSize = xAlign + ( size_t ) ( __tls_end - __tls_start );
+    xBlock = ( ( uintptr_t ) pxTopOfStack - xSize ) & ~( xAlign - 1U );
+
+    /* Clear the TCB and .tbss, then copy in the .tdata initialisers. */
+    memset( ( void * ) xBlock, 0, xSize );
+    memcpy( ( void * ) ( xBlock + xAlign ), __tls_start, ( size_t ) ( __tdata_end - __tls_start ) );
+
+    *ppvTLSBlock = ( void * ) xBlock;
+
+    return ( StackType_t * ) xBlock;
+}
+
+#endif /* portTLS_BLOCK_IN_STACK */
+
+#if ( configUSE_PORT_EXC_STACK_MONITOR == 1 )
+
+void vPortSetExceptionStack( void *pvBase, size_t xSize )
+{
+    PortExcStack_t *pxStack = &xPortExcStacks[ portGET_CORE_ID() ];
+    uint64_t *pullWord = ( uint64_t * ) ( ( ( uintptr_t ) pvBase + 7U ) & ~( uintptr_t ) 7U );
+    uint64_t *pullTop = ( uint64_t * ) ( ( uintptr_t ) pvBase + xSize );
+    uint64_t ullSPEL1, ullSPSel;
+
+    configASSERT( xSize > portEXC_STACK_PAINT_MARGIN );
+
+    /* SP_EL1 cannot be read by name at EL1, so select it for one instruction
+    if this is running on SP_EL0. */
+    __asm volatile ( "MRS   %0, SPSel       \n"
+                     "MSR   SPSel, #1       \n"
+                     "MOV   %1, SP          \n"
+                     "MSR   SPSel, %0       \n"
+                     : "=&r" ( ullSPSel ), "=&r" ( ullSPEL1 ) :: "memory" );
+
+    if( ( ullSPEL1 > ( uint64_t ) pullWord ) && ( ullSPEL1 <= ( uint64_t ) pullTop ) )
+    {
+        pullTop = ( uint64_t * ) ( ullSPEL1 - portEXC_STACK_PAINT_MARGIN );
+    }
+
+    pxStack->pullBase = pullWord;
+    pxStack->pullLowestUsed = pullTop;
+
+    while( pullWord < pullTop )
+    {
+        *pullWord++ = portEXC_STACK_FILL;
+    }
+
+    #if ( configPORT_EXC_STACK_GUARD == 1 )
+    {
+        uint64_t ullGuard = ( ( uint64_t ) pvBase + portEXC_STACK_GUARD_SIZE - 1U ) & ~( ( uint64_t ) portEXC_STACK_GUARD_SIZE - 1U );
+        uint64_t ullMDSCR;
+
+        configASSERT( ( ullGuard + portEXC_STACK_GUARD_SIZE ) < ( uint64_t ) pxStack->pullLowestUsed );
+
+        /* DBGWCR0_EL1: enabled, EL1 only (PAC 0b01), stores only (LSC 0b10),
+        all byte lanes, and MASK covering the whole guard. */
+        __asm volatile ( "MSR   OSLAR_EL1, XZR          \n"
+                         "MSR   DBGWVR0_EL1, %0         \n"
+                         "MSR   DBGWCR0_EL1, %1         \n"
+                         "ISB   SY                      \n"
+                         :: "r" ( ullGuard ),
+                            "r" ( ( 1ULL << 0 ) | ( 1ULL << 1 ) | ( 2ULL << 3 ) | ( 0xffULL << 5 ) | ( ( uint64_t ) portEXC_STACK_GUARD_SIZE_LOG2 << 24 ) )
+                         : "memory" );
+
+        /* MDSCR_EL1.MDE and KDE: watchpoints are taken at EL1 whenever
+        PSTATE.D is clear, which HwiP_IRQ_Handler arranges. */
+        __asm volatile ( "MRS %0, MDSCR_EL1" : "=r" ( ullMDSCR ) );
+        ullMDSCR |= ( 1ULL << 15 ) | ( 1ULL << 13 );
+        __asm volatile ( "MSR MDSCR_EL1, %0\n\tISB SY" :: "r" ( ullMDSCR ) : "memory" );
+    }
+    #endif
+}
+
+size_t xPortGetExceptionStackHighWaterMark( BaseType_t xCoreID )
+{
+    PortExcStack_t *pxStack = &xPortExcStacks[ xCoreID ];
+    const volatile uint64_t *pullWord = pxStack->pullBase;
+
+    configASSERT( ( xCoreID >= 0 ) && ( xCoreID < configNUMBER_OF_CORES ) );
+
+    if( pullWord == NULL )
+    {
+        return 0;
+    }
+
+    /* The stack only ever gets deeper, so nothing above the lowest word
+    found in use by an earlier scan needs looking at again. */
+    while( ( pullWord < pxStack->pullLowestUsed ) && ( *pullWord == portEXC_STACK_FILL ) )
+    {
+        pullWord++;
+    }
+
+    pxStack->pullLowestUsed = ( uint64_t * ) pullWord;
+
+    return ( size_t ) ( ( uintptr_t ) pullWord - ( uintptr_t ) pxStack->pullBase );
+}
+
+#if ( configPORT_EXC_STACK_GUARD == 1 )
+
+/* Called from HwiP_SVC_Abort in portASM.S on a watchpoint hit. */
+void vPortExceptionStackGuardHit( uint64_t ullAddress )
+{
+    DebugP_logError( "[FreeRTOS] Exception stack overflow on core %d at 0x%llx", ( int ) portGET_CORE_ID(), ( unsigned long long ) ullAddress );
+    DebugP_assertNoLog( 0 );
+}
+
+#endif /* configPORT_EXC_STACK_GUARD */
+
+#endif /* configUSE_PORT_EXC_STACK_MONITOR */
+
 #if ( configSUPPORT_STATIC_ALLOCATION == 1 ) && ( configKERNEL_PROVIDED_STATIC_MEMORY == 0 )
     static StaticTask_t xIdleTaskTCB;
     static StackType_t uxIdleTaskStack[ configMINIMAL_STACK_SIZE ];
@@ -344,6 +842,26 @@ void vApplicationStackOverflowHook( TaskHandle_t xTask,
     }
 #endif
 
+static void prvIdleWaitForInterrupt( void )
+{
+    #if ( configUSE_PORT_LOAD_ACCOUNTING == 1 )
+    {
+        /* Mask IRQs so the time until the wake-up interrupt is taken is all
+        accounted as WFI.  WFI still wakes on a masked interrupt, which is
+        then taken, and accounted as ISR time, once IRQs are unmasked. */
+        __asm volatile ( "MSR DAIFSET, #2\n\tISB SY" ::: "memory" );
+        prvLoadEnterState( portLOAD_STATE_WFI );
+        __asm volatile ( "DSB SY\n\tWFI" ::: "memory" );
+        prvLoadEnterState( portLOAD_STATE_TASK );
+        __asm volatile ( "MSR DAIFCLR, #2\n\tISB SY" ::: "memory" );
+    }
+    #else
+    {
+        __asm__ volatile ("wfi");
+    }
+    #endif
+}
+
 /* This function is called when configUSE_IDLE_HOOK is 1 in FreeRTOSConfig.h */
 void vApplicationIdleHook( void )
 {
@@ -351,7 +869,7 @@ void vApplicationIdleHook( void )
 
     vApplicationLoadHook();
 
-    __asm__ volatile ("wfi");
+    prvIdleWaitForInterrupt();
 }
 
 /* This function is called when configUSE_MINIMAL_IDLE_HOOK is 1 in FreeRTOSConfig.h */
@@ -361,15 +879,144 @@ void vApplicationMinimalIdleHook( void )
 
     vApplicationLoadHook();
 
-    __asm__ volatile ("wfi");
+    prvIdleWaitForInterrupt();
 }
 
+/* Scale from generic counter ticks to microseconds as a 0.64 fixed point
+fraction, so a conversion is a single UMULH:
+usecs = ( count * ullRunTimeCounterScale ) >> 64 */
+static uint64_t ullRunTimeCounterScale = 0;
+
 /* initialize high resolution timer for CPU and task load calculation */
 void vPortConfigTimerForRunTimeStats()
 {
     /* we assume clock is initialized before the schedular is started */
+    uint64_t ullFrequency;
+
+    __asm volatile ( "MRS %0, CNTFRQ_EL0" : "=r" ( ullFrequency ) );
+
+    /* The scale must be below 1.0, i.e. the counter must run faster than
+    1MHz, which the architecture requires anyway. */
+    configASSERT( ullFrequency > 1000000ULL );
+
+    ullRunTimeCounterScale = ( uint64_t ) ( ( ( ( unsigned __int128 ) 1000000ULL ) << 64 ) / ullFrequency );
 }
 
+/* return the 64b system counter (CNTVCT_EL0) in units of usecs.  This is the
+same on all cores, does not overflow in practice, and is exact to within one
+microsecond for the lifetime of the system, so it can back
+configRUN_TIME_COUNTER_TYPE = uint64_t directly. */
+uint64_t ullPortGetRunTimeCounterValue( void )
+{
+    return prvCounterToUsecs( prvReadCounter() );
+}
+
+static inline uint64_t prvReadCounter( void )
+{
+    uint64_t ullCount;
+
+    __asm volatile ( "ISB SY\n\tMRS %0, CNTVCT_EL0" : "=r" ( ullCount ) :: "memory" );
+
+    return ullCount;
+}
+
+static uint64_t prvCounterToUsecs( uint64_t ullCount )
+{
+    if( ullRunTimeCounterScale == 0 )
+    {
+        vPortConfigTimerForRunTimeStats();
+    }
+
+    return ( uint64_t ) ( ( ( unsigned __int128 ) ullCount * ullRunTimeCounterScale ) >> 64 );
+}
+
+#if ( configUSE_PORT_LOAD_ACCOUNTING == 1 )
+
+static void prvLoadInit( void )
+{
+    PortLoadData_t *pxLoadData = &xPortLoadData[ portGET_CORE_ID() ];
+
+    pxLoadData->ulState = portLOAD_STATE_TASK;
+    pxLoadData->ullTimestamp = prvReadCounter();
+}
+
+/* Called by the owning core with IRQs masked. */
+static void prvLoadEnterState( uint32_t ulState )
+{
+    PortLoadData_t *pxLoadData = &xPortLoadData[ portGET_CORE_ID() ];
+    uint64_t ullNow;
+
+    /* Not yet started on this core. */
+    if( pxLoadData->ullTimestamp == 0 )
+    {
+        return;
+    }
+
+    ullNow = prvReadCounter();
+
+    pxLoadData->ulSequence++;
+    __asm volatile ( "DMB ISHST" ::: "memory" );
+
+    pxLoadData->ullCounts[ pxLoadData->ulState ] += ullNow - pxLoadData->ullTimestamp;
+    pxLoadData->ullTimestamp = ullNow;
+    pxLoadData->ulState = ulState;
+
+    __asm volatile ( "DMB ISHST" ::: "memory" );
+    pxLoadData->ulSequence++;
+}
+
+/* Called from portASM.S on entry to and exit from the outermost IRQ. */
+void vPortLoadIrqEnter( void )
+{
+    prvLoadEnterState( portLOAD_STATE_ISR );
+}
+
+void vPortLoadIrqExit( void )
+{
+    prvLoadEnterState( portLOAD_STATE_TASK );
+}
+
+void vPortGetCoreLoad( BaseType_t xCoreID, PortCoreLoad_t *pxLoad )
+{
+    const PortLoadData_t *pxLoadData = &xPortLoadData[ xCoreID ];
+    uint64_t ullCounts[ portLOAD_STATE_COUNT ];
+    uint64_t ullNow;
+    uint32_t ulSequence, ulState, x;
+
+    configASSERT( ( xCoreID >= 0 ) && ( xCoreID < configNUMBER_OF_CORES ) );
+
+    do
+    {
+        ulSequence = pxLoadData->ulSequence;
+        __asm volatile ( "DMB ISHLD" ::: "memory" );
+
+        for( x = 0; x < portLOAD_STATE_COUNT; x++ )
+        {
+            ullCounts[ x ] = pxLoadData->ullCounts[ x ];
+        }
+
+        ulState = pxLoadData->ulState;
+        ullNow = prvReadCounter();
+
+        /* Add the time spent so far in the current state. */
+        if( pxLoadData->ullTimestamp != 0 )
+        {
+            ullCounts[ ulState ] += ullNow - pxLoadData->ullTimestamp;
+        }
+
+        __asm volatile ( "DMB ISHLD" ::: "memory" );
+    } while( ( ( ulSequence & 1U ) != 0 ) || ( ulSequence != pxLoadData->ulSequence ) );
+
+    pxLoad->ullTimestamp = prvCounterToUsecs( ullNow );
+
+    for( x = 0; x < portLOAD_STATE_COUNT; x++ )
+    {
+        pxLoad->ullTime[ x ] = prvCounterToUsecs( ullCounts[ x ] );
+    }
+}
+
+#endif /* configUSE_PORT_LOAD_ACCOUNTING */
+
 /* return current counter value of high speed counter in units of usecs */
 uint32_t uiPortGetRunTimeCounterValue()
 {
@@ -386,9 +1033,427 @@ uint32_t uiPortGetRunTimeCounterValue()
     return (uint32_t)(timeInUsecs);
 }
 
+#if ( configUSE_PORT_PMU_TRACE == 1 )
+
+static inline uint64_t prvPMUReadCycles( void )
+{
+    uint64_t ullCycles;
+
+    __asm volatile ( "MRS %0, PMCCNTR_EL0" : "=r" ( ullCycles ) :: "memory" );
+
+    return ullCycles;
+}
+
+static void prvPMUInit( PortCoreData_t *pxCoreData )
+{
+    PortPMUData_t *pxPMUData = &xPortPMUData[ pxCoreData->ullCoreIndex ];
+
+    __asm volatile ( "MSR PMCR_EL0, %0          \n"
+                     "MSR PMCNTENSET_EL0, %1    \n"
+                     "ISB SY                    \n"
+                     :: "r" ( portPMCR_E_C_LC ), "r" ( portPMCNTENSET_C ) : "memory" );
+
+    pxCoreData->ullPMUData = ( uint64_t ) pxPMUData;
+}
+
+static void prvPMURecord( PortPMUPhaseStats_t *pxStats, uint64_t ullStart, uint64_t ullEnd )
+{
+    uint64_t ullCycles;
+    uint32_t ulBucket;
+
+    /* Nothing sampled yet, or the counter was reset in between. */
+    if( ( ullStart == 0 ) || ( ullEnd < ullStart ) )
+    {
+        return;
+    }
+
+    ullCycles = ullEnd - ullStart;
+
+    if( ( pxStats->ullCount == 0 ) || ( ullCycles < pxStats->ullMin ) )
+    {
+        pxStats->ullMin = ullCycles;
+    }
+
+    if( ullCycles > pxStats->ullMax )
+    {
+        pxStats->ullMax = ullCycles;
+    }
+
+    pxStats->ullSum += ullCycles;
+    pxStats->ullCount++;
+
+    ulBucket = ( uint32_t ) ( 63 - __builtin_clzll( ullCycles | 1ULL ) );
+    if( ulBucket >= portPMU_HISTOGRAM_BUCKETS )
+    {
+        ulBucket = portPMU_HISTOGRAM_BUCKETS - 1;
+    }
+    pxStats->ulHistogram[ ulBucket ]++;
+}
+
+/* Close the restore phase of the last context switch, if it has ended. */
+static void prvPMUCloseSwitch( PortPMUData_t *pxPMUData )
+{
+    if( ( pxPMUData->ullSwitchSaved != 0 ) && ( pxPMUData->ullStampSwitchDone != 0 ) )
+    {
+        prvPMURecord( &pxPMUData->xPhase[ portPMU_PHASE_SWITCH_RESTORE ], pxPMUData->ullSwitchSaved, pxPMUData->ullStampSwitchDone );
+        pxPMUData->ullSwitchSaved = 0;
+        pxPMUData->ullStampSwitchDone = 0;
+    }
+}
+
+/* Called by HwiP_IRQ_Handler when the C handler returns. */
+void vPortPMUIrqDone( void )
+{
+    uint64_t ullNow = prvPMUReadCycles();
+    PortPMUData_t *pxPMUData = &xPortPMUData[ portGET_CORE_ID() ];
+
+    prvPMURecord( &pxPMUData->xPhase[ portPMU_PHASE_IRQ_HANDLER ], pxPMUData->ullStampIrqEntry, ullNow );
+    prvPMUCloseSwitch( pxPMUData );
+}
+
+/* Called by portSWITCH_CONTEXT once the outgoing context is saved. */
+void vPortPMUSwitchSaved( void )
+{
+    uint64_t ullNow = prvPMUReadCycles();
+    PortPMUData_t *pxPMUData = &xPortPMUData[ portGET_CORE_ID() ];
+
+    prvPMUCloseSwitch( pxPMUData );
+    prvPMURecord( &pxPMUData->xPhase[ portPMU_PHASE_SWITCH_SAVE ], pxPMUData->ullStampSwitchStart, ullNow );
+    pxPMUData->ullSwitchSaved = ullNow;
+}
+
+void vPortPMUGetStats( BaseType_t xCoreID, UBaseType_t uxPhase, PortPMUPhaseStats_t *pxStats )
+{
+    configASSERT( ( xCoreID < configNUMBER_OF_CORES ) && ( uxPhase < portPMU_PHASE_COUNT ) );
+
+    *pxStats = xPortPMUData[ xCoreID ].xPhase[ uxPhase ];
+}
+
+void vPortPMUResetStats( void )
+{
+    BaseType_t xCore;
+    UBaseType_t uxPhase;
+
+    for( xCore = 0; xCore < configNUMBER_OF_CORES; xCore++ )
+    {
+        for( uxPhase = 0; uxPhase < portPMU_PHASE_COUNT; uxPhase++ )
+        {
+            memset( &xPortPMUData[ xCore ].xPhase[ uxPhase ], 0, sizeof( PortPMUPhaseStats_t ) );
+        }
+    }
+}
+
+void vPortPMUDumpStats( void )
+{
+    static const char * const pcPhaseNames[ portPMU_PHASE_COUNT ] = { "irq_handler", "switch_save", "switch_restore" };
+    PortPMUPhaseStats_t xStats;
+    BaseType_t xCore;
+    UBaseType_t uxPhase;
+    uint32_t ulBucket;
+
+    DebugP_log("[FreeRTOS] PMU cycles: core phase count min mean max | log2 histogram\r\n");
+
+    for( xCore = 0; xCore < configNUMBER_OF_CORES; xCore++ )
+    {
+        for( uxPhase = 0; uxPhase < portPMU_PHASE_COUNT; uxPhase++ )
+        {
+            vPortPMUGetStats( xCore, uxPhase, &xStats );
+
+            DebugP_log("%d %s %llu %llu %llu %llu |", ( int ) xCore, pcPhaseNames[ uxPhase ],
+                       ( unsigned long long ) xStats.ullCount,
+                       ( unsigned long long ) xStats.ullMin,
+                       ( unsigned long long ) ( ( xStats.ullCount != 0 ) ? ( xStats.ullSum / xStats.ullCount ) : 0 ),
+                       ( unsigned long long ) xStats.ullMax );
+
+            for( ulBucket = 0; ulBucket < portPMU_HISTOGRAM_BUCKETS; ulBucket++ )
+            {
+                DebugP_log(" %u", ( unsigned int ) xStats.ulHistogram[ ulBucket ]);
+            }
+
+            DebugP_log("\r\n");
+        }
+    }
+}
+
+#endif /* configUSE_PORT_PMU_TRACE */
+
+#if ( configASSERT_DEFINED == 1 )
+
+void vPortValidateInterruptPriority( void )
+{
+    uint64_t ullRPR;
+
+    /* ICC_RPR_EL1 holds the priority of the highest priority active interrupt
+    on this core, or 0xFF when none is active. */
+    __asm volatile ( "MRS %0, S3_0_C12_C11_3" : "=r" ( ullRPR ) :: "memory" );	/* ICC_RPR_EL1 */
+
+    /* An interrupt above configMAX_API_CALL_INTERRUPT_PRIORITY is not masked
+    by critical sections, so it must not call the API. */
+    configASSERT( ( ullRPR & 0xFFULL ) >= portMAX_API_PRIORITY_MASK );
+}
+
+#endif /* configASSERT_DEFINED */
+
+#if ( configUSE_IRQ_NESTING == 1 )
+
+/* HwiP_intrHandler() cannot simply be called with PSTATE.I clear, as it ends
+the interrupt (ICC_EOIR1_EL1) before returning, and an interrupt of the same
+priority could then nest on top of it, again and again under load.  So the
+handler table is read here, and the build fails if the DPL changes it. */
+_Static_assert( ( sizeof( gHwiCtrl.isr ) / sizeof( gHwiCtrl.isr[ 0 ] ) ) == HwiP_MAX_INTERRUPTS, "gHwiCtrl.isr layout" );
+_Static_assert( ( sizeof( gHwiCtrl.isrArgs ) / sizeof( gHwiCtrl.isrArgs[ 0 ] ) ) == HwiP_MAX_INTERRUPTS, "gHwiCtrl.isrArgs layout" );
+_Static_assert( __builtin_types_compatible_p( __typeof__( gHwiCtrl.isr[ 0 ] ), HwiP_FxnCallback ), "gHwiCtrl.isr type" );
+_Static_assert( __builtin_types_compatible_p( __typeof__( gHwiCtrl.isrArgs[ 0 ] ), void * ), "gHwiCtrl.isrArgs type" );
+
+/* Called by HwiP_IRQ_Handler in place of HwiP_intrHandler().  Reading
+ICC_IAR1_EL1 raises the GIC running priority to that of the interrupt, so
+once PSTATE.I is cleared only interrupts of higher priority can preempt the
+handler.  portASM.S keeps the nesting count and only switches context when
+the outermost interrupt returns. */
+void vPortIRQHandler( void )
+{
+    uint64_t ullIAR;
+    uint32_t ulIntNum;
+
+    __asm volatile ( "MRS %0, S3_0_C12_C12_0" : "=r" ( ullIAR ) :: "memory" );	/* ICC_IAR1_EL1 */
+    ulIntNum = ( uint32_t ) ( ullIAR & 0xFFFFFFU );
+
+    if( ulIntNum < HwiP_MAX_INTERRUPTS )
+    {
+        __asm volatile ( "MSR DAIFCLR, #2" ::: "memory" );
+
+        if( gHwiCtrl.isr[ ulIntNum ] != NULL )
+        {
+            gHwiCtrl.isr[ ulIntNum ]( gHwiCtrl.isrArgs[ ulIntNum ] );
+        }
+
+        __asm volatile ( "MSR DAIFSET, #2" ::: "memory" );
+
+        /* Priority drop and deactivate. */
+        __asm volatile ( "MSR S3_0_C12_C12_1, %0\n\tISB SY" :: "r" ( ullIAR ) : "memory" );	/* ICC_EOIR1_EL1 */
+    }
+    else
+    {
+        /* Spurious, nothing to acknowledge. */
+        gHwiCtrl.spuriousIRQCount++;
+    }
+}
+
+#endif /* configUSE_IRQ_NESTING */
+
+/* Raise SGI ulIntNum on every core whose bit is set in ullCoreMask, with one
+ICC_SGI1R_EL1 write per cluster. */
+static void prvSendSGI( uint32_t ulIntNum, uint64_t ullCoreMask )
+{
+    const uint32_t ulCoresPerCluster = 1U << portCLUSTER_CORE_SHIFT;
+    const uint64_t ullTargetListMask = ( 1ULL << ulCoresPerCluster ) - 1ULL;
+    uint64_t ullCluster = 0;
+    uint64_t ullTargetList;
+    uint64_t ullSGI1R;
+
+    /* Make the memory updates that caused the SGI visible to the target
+    cores before they take the interrupt. */
+    __asm volatile ( "DSB ISHST" ::: "memory" );
+
+    while( ullCoreMask != 0 )
+    {
+        ullTargetList = ullCoreMask & ullTargetListMask;
+
+        if( ullTargetList != 0 )
+        {
+            /* ICC_SGI1R_EL1: INTID [27:24], Aff1 [23:16], TargetList [15:0]. */
+            ullSGI1R = ( ( uint64_t ) ulIntNum << 24 ) | ( ullCluster << 16 ) | ullTargetList;
+            __asm volatile ( "MSR S3_0_C12_C11_5, %0" :: "r" ( ullSGI1R ) : "memory" );
+        }
+
+        ullCoreMask >>= ulCoresPerCluster;
+        ullCluster++;
+    }
+
+    __asm volatile ( "ISB SY" ::: "memory" );
+}
+
+void vPortYieldCores( uint64_t ullCoreMask )
+{
+    prvSendSGI( YIELD_CORE_INTERRUPT_NO, ullCoreMask );
+}
+
+void vPortYieldCore( BaseType_t xCoreID )
+{
+    PortCoreData_t *pxCoreData = &xPortCoreData[ portGET_CORE_ID() ];
+
+    if( pxCoreData->ullYieldBatching != pdFALSE )
+    {
+        pxCoreData->ullYieldBatchMask |= ( 1ULL << xCoreID );
+    }
+    else
+    {
+        vPortYieldCores( 1ULL << xCoreID );
+    }
+}
+
+#if ( configUSE_PORT_MAILBOX == 1 )
+
+static PortMailbox_t * volatile pxMailboxes[ configPORT_MAILBOX_MAX ];
+static HwiP_Object xMailboxHwiObjects[ configNUMBER_OF_CORES ];
+
+/* Doorbell SGI handler, registered on every core. */
+static void prvMailboxDoorbellISR( void *pvArgs )
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    uint32_t ulCoreID = ( uint32_t ) portGET_CORE_ID();
+    uint32_t x;
+    PortMailbox_t *pxMailbox;
+
+    ( void ) pvArgs;
+
+    for( x = 0; x < configPORT_MAILBOX_MAX; x++ )
+    {
+        pxMailbox = pxMailboxes[ x ];
+
+        if( ( pxMailbox != NULL ) && ( pxMailbox->ulConsumerCore == ulCoreID ) && ( pxMailbox->ulDoorbell != 0 ) )
+        {
+            pxMailbox->ulDoorbell = 0;
+
+            if( pxMailbox->pvConsumerTask != NULL )
+            {
+                vTaskNotifyGiveIndexedFromISR( ( TaskHandle_t ) pxMailbox->pvConsumerTask, configPORT_MAILBOX_NOTIFY_INDEX, &xHigherPriorityTaskWoken );
+            }
+        }
+    }
+
+    portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+}
+
+static void prvSetupMailboxDoorbell( void )
+{
+    HwiP_Params xHwiParams;
+
+    /* SGIs are banked, so each core registers its own handler. */
+    HwiP_Params_init( &xHwiParams );
+    xHwiParams.intNum = configPORT_MAILBOX_SGI;
+    xHwiParams.callback = prvMailboxDoorbellISR;
+    xHwiParams.priority = configKERNEL_INTERRUPT_PRIORITY;
+    ( void ) HwiP_construct( &xMailboxHwiObjects[ portGET_CORE_ID() ], &xHwiParams );
+}
+
+BaseType_t xPortMailboxInit( PortMailbox_t *pxMailbox, PortMailboxSlot_t *pxSlots, uint32_t ulSlotCount )
+{
+    BaseType_t xReturn = pdFAIL;
+    uint64_t ullState;
+    uint32_t x;
+
+    /* The slot count must be a power of two. */
+    configASSERT( ( ulSlotCount != 0 ) && ( ( ulSlotCount & ( ulSlotCount - 1U ) ) == 0 ) );
+
+    pxMailbox->ulHead = 0;
+    pxMailbox->ulTail = 0;
+    pxMailbox->pxSlots = pxSlots;
+    pxMailbox->ulMask = ulSlotCount - 1U;
+    pxMailbox->ulDoorbell = 0;
+    pxMailbox->ulConsumerCore = 0;
+    pxMailbox->pvConsumerTask = NULL;
+
+    ullState = portSET_INTERRUPT_MASK_FROM_ISR();
+    {
+        for( x = 0; x < configPORT_MAILBOX_MAX; x++ )
+        {
+            if( pxMailboxes[ x ] == NULL )
+            {
+                pxMailboxes[ x ] = pxMailbox;
+                xReturn = pdPASS;
+                break;
+            }
+        }
+    }
+    portCLEAR_INTERRUPT_MASK_FROM_ISR( ullState );
+
+    return xReturn;
+}
+
+BaseType_t xPortMailboxSend( PortMailbox_t *pxMailbox, const PortMailboxMessage_t *pxMessage )
+{
+    uint32_t ulHead = pxMailbox->ulHead;
+    uint32_t ulTail = __atomic_load_n( &pxMailbox->ulTail, __ATOMIC_ACQUIRE );
+
+    if( ( ulHead - ulTail ) > pxMailbox->ulMask )
+    {
+        /* Full. */
+        return pdFAIL;
+    }
+
+    pxMailbox->pxSlots[ ulHead & pxMailbox->ulMask ].xMessage = *pxMessage;
+    __atomic_store_n( &pxMailbox->ulHead, ulHead + 1U, __ATOMIC_RELEASE );
+
+    /* Order the head store before the tail load below, pairing with the
+    barrier in xPortMailboxReceive(): either the consumer sees the new head,
+    or this core sees that the mailbox was empty and rings the doorbell. */
+    __asm volatile ( "DMB ISH" ::: "memory" );
+
+    if( __atomic_load_n( &pxMailbox->ulTail, __ATOMIC_RELAXED ) == ulHead )
+    {
+        pxMailbox->ulDoorbell = 1;
+        prvSendSGI( configPORT_MAILBOX_SGI, 1ULL << pxMailbox->ulConsumerCore );
+    }
+
+    return pdPASS;
+}
+
+BaseType_t xPortMailboxReceive( PortMailbox_t *pxMailbox, PortMailboxMessage_t *pxMessage, TickType_t xTicksToWait )
+{
+    uint32_t ulTail = pxMailbox->ulTail;
+    TimeOut_t xTimeOut;
+    BaseType_t xEntryTimeSet = pdFALSE;
+
+    pxMailbox->pvConsumerTask = ( void * ) xTaskGetCurrentTaskHandle();
+
+    for( ;; )
+    {
+        if( __atomic_load_n( &pxMailbox->ulHead, __ATOMIC_ACQUIRE ) != ulTail )
+        {
+            *pxMessage = pxMailbox->pxSlots[ ulTail & pxMailbox->ulMask ].xMessage;
+            __atomic_store_n( &pxMailbox->ulTail, ulTail + 1U, __ATOMIC_RELEASE );
+            return pdPASS;
+        }
+
+        if( xTicksToWait == 0 )
+        {
+            return pdFAIL;
+        }
+
+        if( xEntryTimeSet == pdFALSE )
+        {
+            vTaskSetTimeOutState( &xTimeOut );
+            xEntryTimeSet = pdTRUE;
+        }
+
+        /* Empty.  Have the doorbell sent to this core, then check again after
+        the barrier in case the producer saw the mailbox as not empty. */
+        pxMailbox->ulConsumerCore = ( uint32_t ) portGET_CORE_ID();
+        __asm volatile ( "DMB ISH" ::: "memory" );
+
+        if( __atomic_load_n( &pxMailbox->ulHead, __ATOMIC_ACQUIRE ) != ulTail )
+        {
+            continue;
+        }
+
+        /* A wake with nothing to read, for example from a doorbell for a
+        message that was already taken, only waits out what is left of the
+        timeout. */
+        ( void ) ulTaskNotifyTakeIndexed( configPORT_MAILBOX_NOTIFY_INDEX, pdTRUE, xTicksToWait );
+
+        if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) != pdFALSE )
+        {
+            xTicksToWait = 0;
+        }
+    }
+}
+
+#endif /* configUSE_PORT_MAILBOX */
+
 int32_t Signal_coreIntr( CSL_gic500_gicrRegs *pGic500GicrRegs, uint32_t coreId, uint32_t intrNum )
 {
-	if ( coreId < configNUM_CORES )
+	if ( coreId < configNUMBER_OF_CORES )
 	{
 		if ( intrNum < HWIP_GICD_SGI_PPI_INTR_ID_MAX )
 		{
@@ -402,6 +1467,56 @@ int32_t Signal_coreIntr( CSL_gic500_gicrRegs *pGic500GicrRegs, uint32_t coreId,
 	return SystemP_SUCCESS;
 }
 
+void vPortLockContended( PortRecursiveLock_t *pxLock, uint32_t ulLockNum, BaseType_t xCoreID )
+{
+    #if ( configPORT_LOCK_WAIT_BOUND_USECS > 0 )
+    {
+        uint64_t ullStart, ullWait, ullFrequency;
+
+        ullStart = prvReadCounter();
+        GateSmp_lock( &pxLock->ulGate );
+        ullWait = prvReadCounter() - ullStart;
+
+        /* The lock is held from here, so the statistics need no atomics. */
+        if( ullWait > pxLock->ullMaxWait )
+        {
+            pxLock->ullMaxWait = ullWait;
+        }
+
+        __asm volatile ( "MRS %0, CNTFRQ_EL0" : "=r" ( ullFrequency ) );
+
+        if( ullWait > ( ( ullFrequency / 1000000ULL ) * configPORT_LOCK_WAIT_BOUND_USECS ) )
+        {
+            pxLock->ulLongWaits++;
+            portLOCK_WAIT_EXCEEDED( ulLockNum, xCoreID, prvCounterToUsecs( ullWait ) );
+        }
+    }
+    #else
+    {
+        ( void ) ulLockNum;
+        ( void ) xCoreID;
+
+        GateSmp_lock( &pxLock->ulGate );
+    }
+    #endif
+}
+
+void vPortGetLockWaitStats( uint32_t ulLockNum, uint32_t *pulLongWaits, uint64_t *pullMaxWaitUsecs )
+{
+    configASSERT( ulLockNum < portRTOS_LOCK_COUNT );
+
+    *pulLongWaits = xPortLocks[ ulLockNum ].ulLongWaits;
+    *pullMaxWaitUsecs = prvCounterToUsecs( xPortLocks[ ulLockNum ].ullMaxWait );
+}
+
+void vPortResetLockWaitStats( uint32_t ulLockNum )
+{
+    configASSERT( ulLockNum < portRTOS_LOCK_COUNT );
+
+    xPortLocks[ ulLockNum ].ulLongWaits = 0;
+    xPortLocks[ ulLockNum ].ullMaxWait = 0;
+}
+
 /* Read 64b value shared between cores */
 uint64_t Get_64(volatile uint64_t* x)
 {
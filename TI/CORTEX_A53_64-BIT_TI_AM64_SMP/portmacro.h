@@ -67,6 +67,8 @@
 #include <kernel/a53/HwiP_armv8_gic.h>
 #include <kernel/a53/common_armv8.h>
 
+#include "portmacro_common.h"
+
 /*-----------------------------------------------------------
  * Port specific definitions.
  *
@@ -104,21 +106,184 @@ not need to be guarded with a critical section. */
 #define portPOINTER_SIZE_TYPE 		uint64_t
 #define portCRITICAL_NESTING_IN_TCB 1
 
+/* Per-core port state.  Each core's entry occupies its own cache line so an
+IRQ on one core never writes a line that another core is reading, and the
+address of the calling core's entry is kept in TPIDR_EL1 so the IRQ and SVC
+paths in portASM.S reach it with a single register read.  The field offsets
+used by portASM.S are in portmacro_common.h. */
+#define portCACHE_LINE_SIZE						64
+
+typedef struct xPORT_CORE_DATA
+{
+	volatile uint64_t ullYieldRequired;		/* Set to 1 to pend a context switch from an ISR. */
+	volatile uint64_t ullInterruptNesting;	/* Interrupt nesting depth. */
+	volatile uint64_t ullTaskHasFPUContext;	/* Non-zero if the running task has an FPU context. */
+	uint64_t ullCoreIndex;					/* portGET_CORE_ID() of the owning core. */
+	uint64_t ullFPUSaveArea;				/* Running task's FPU save area (configUSE_TASK_FPU_SUPPORT == 2). */
+	uint64_t ullYieldBatching;				/* Non-zero while portYIELD_CORE() requests are being collected. */
+	uint64_t ullYieldBatchMask;				/* Cores to interrupt once collection ends. */
+	uint64_t ullPMUData;					/* PortPMUData_t of this core (configUSE_PORT_PMU_TRACE == 1). */
+} __attribute__( ( aligned( portCACHE_LINE_SIZE ) ) ) PortCoreData_t;
+
+extern PortCoreData_t xPortCoreData[];
+
+/* Sets TPIDR_EL1 to the calling core's xPortCoreData[] entry.  The IRQ
+handler only reads TPIDR_EL1, so the start-up code must call this on each core
+before that core enables interrupts.  xPortStartScheduler() calls it again,
+which is harmless. */
+void vPortInitCoreData( void );
+
+/* Set configUSE_PORT_PMU_TRACE to 1 to time the IRQ and context switch paths
+of portASM.S with the PMU cycle counter (PMCCNTR_EL0), which the port then
+enables on each core.  Each core keeps min, max, mean and a log2 histogram of
+the cycles spent in each phase:
+
+portPMU_PHASE_IRQ_HANDLER      - IRQ entry (after the scratch registers are
+                                 saved) to the return of the C handler.
+portPMU_PHASE_SWITCH_SAVE      - start of a context switch to the end of
+                                 portSAVE_CONTEXT.
+portPMU_PHASE_SWITCH_RESTORE   - end of portSAVE_CONTEXT, through
+                                 vTaskSwitchContext(), to just before the ERET
+                                 into the selected task.
+
+The figures include the cost of sampling itself, a few tens of cycles.  With
+configUSE_IRQ_NESTING an interrupt that is preempted is only timed from the
+entry of the interrupt that preempted it. */
+#ifndef configUSE_PORT_PMU_TRACE
+	#define configUSE_PORT_PMU_TRACE	0
+#endif
+
+#define portPMU_PHASE_IRQ_HANDLER		0
+#define portPMU_PHASE_SWITCH_SAVE		1
+#define portPMU_PHASE_SWITCH_RESTORE	2
+#define portPMU_PHASE_COUNT				3
+
+/* Bucket n counts samples of 2^n to 2^(n+1)-1 cycles. */
+#define portPMU_HISTOGRAM_BUCKETS		24
+
+typedef struct xPORT_PMU_PHASE_STATS
+{
+	uint64_t ullMin;
+	uint64_t ullMax;
+	uint64_t ullSum;
+	uint64_t ullCount;
+	uint32_t ulHistogram[ portPMU_HISTOGRAM_BUCKETS ];
+} PortPMUPhaseStats_t;
+
+/* Copy the statistics of one phase on one core. */
+void vPortPMUGetStats( BaseType_t xCoreID, UBaseType_t uxPhase, PortPMUPhaseStats_t *pxStats );
+
+/* Clear the statistics of all cores. */
+void vPortPMUResetStats( void );
+
+/* Print the statistics of all cores with DebugP_log(). */
+void vPortPMUDumpStats( void );
+
+/* Set configUSE_PORT_LOAD_ACCOUNTING to 1 to have each core account its time
+to one of three states from the generic counter, at every transition:
+
+portLOAD_STATE_TASK   - running a task, including the idle task outside WFI.
+portLOAD_STATE_ISR    - outermost IRQ entry to exit in portASM.S.
+portLOAD_STATE_WFI    - waiting for an interrupt in the idle hooks or in
+                        vPortSuppressTicksAndSleep().
+
+The totals are 64-bit microsecond counts that never wrap in practice.  Take
+two snapshots and subtract them to get the utilisation over any window. */
+#ifndef configUSE_PORT_LOAD_ACCOUNTING
+	#define configUSE_PORT_LOAD_ACCOUNTING	0
+#endif
+
+#define portLOAD_STATE_TASK		0
+#define portLOAD_STATE_ISR		1
+#define portLOAD_STATE_WFI		2
+#define portLOAD_STATE_COUNT	3
+
+typedef struct xPORT_CORE_LOAD
+{
+	uint64_t ullTimestamp;							/* Time of the snapshot, in usecs. */
+	uint64_t ullTime[ portLOAD_STATE_COUNT ];		/* Time spent in each state, in usecs. */
+} PortCoreLoad_t;
+
+/* Take a consistent snapshot of the totals of one core, including the time
+spent so far in that core's current state.  Can be called from any core. */
+void vPortGetCoreLoad( BaseType_t xCoreID, PortCoreLoad_t *pxLoad );
+
+/* Set configUSE_PORT_EXC_STACK_MONITOR to 1 to track how deep each core's
+exception stack (SP_EL1, used by the IRQ handler and nested interrupts) gets.
+The stacks belong to the start-up code, so it must pass each one to
+vPortSetExceptionStack() on the core that owns it, before the scheduler
+starts.  The unused part is then painted, and
+xPortGetExceptionStackHighWaterMark() scans it from the bottom for the least
+free space there has ever been.  The scan is cheap after the first call but
+is best left to a low priority task.
+
+With configPORT_EXC_STACK_GUARD also set to 1, the lowest
+portEXC_STACK_GUARD_SIZE bytes of the stack (aligned up) are covered by
+hardware watchpoint 0, and a store to them reports the overflow and stops the
+core.  This needs the debug logic to be free, so not with a debugger that
+uses watchpoint 0. */
+#ifndef configUSE_PORT_EXC_STACK_MONITOR
+	#define configUSE_PORT_EXC_STACK_MONITOR	0
+#endif
+
+#ifndef configPORT_EXC_STACK_GUARD
+	#define configPORT_EXC_STACK_GUARD			0
+#endif
+
+#if ( configPORT_EXC_STACK_GUARD == 1 ) && ( configUSE_PORT_EXC_STACK_MONITOR == 0 )
+	#error configPORT_EXC_STACK_GUARD requires configUSE_PORT_EXC_STACK_MONITOR.
+#endif
+
+/* Leaves room below the watched address for the overflow report itself. */
+#define portEXC_STACK_GUARD_SIZE_LOG2			10
+#define portEXC_STACK_GUARD_SIZE				( 1U << portEXC_STACK_GUARD_SIZE_LOG2 )
+
+void vPortSetExceptionStack( void *pvBase, size_t xSize );
+size_t xPortGetExceptionStackHighWaterMark( BaseType_t xCoreID );
+
+/* TPIDR_EL0 is part of each task's context, so a task can keep a per-task
+pointer there and read it back with a single MRS.
+
+With configUSE_C_RUNTIME_TLS_SUPPORT set to 1 the port also provides the
+kernel's TLS hooks for compiler generated thread-local storage (__thread), as
+laid out by the AArch64 ELF ABI: a copy of the static TLS block (.tdata then
+.tbss) is carved from the top of each task's stack when the task is created,
+and TPIDR_EL0 points at the 16-byte TCB just below it.  The linker script
+must define __tls_start, __tdata_end, __tls_end and __tls_align around the
+two sections, see qemu_virt/linker.ld.  TLS variables cannot be used before
+the scheduler starts.  Since TPIDR_EL0 comes from the context, a
+configSET_TLS_BLOCK() supplied by the application would have no effect. */
+#if ( configUSE_C_RUNTIME_TLS_SUPPORT == 1 ) && !defined( configTLS_BLOCK_TYPE )
+	#define portTLS_BLOCK_IN_STACK							1
+	#define configTLS_BLOCK_TYPE							void *
+	#define configINIT_TLS_BLOCK( xTLSBlock, pxTopOfStack )	( pxTopOfStack ) = pxPortInitTLSBlock( &( xTLSBlock ), ( pxTopOfStack ) )
+	#define configSET_TLS_BLOCK( xTLSBlock )
+	#define configDEINIT_TLS_BLOCK( xTLSBlock )
+
+	StackType_t *pxPortInitTLSBlock( void **ppvTLSBlock, StackType_t *pxTopOfStack );
+#else
+	#define portTLS_BLOCK_IN_STACK							0
+#endif
+
 /* Task utilities. */
 
-extern uint64_t ullPortYieldRequired[];
-/* Called at the end of an ISR that can cause a context switch. */
+/* Called at the end of an ISR that can cause a context switch.  The running
+priority is checked here too, so an interrupt that only requests a switch,
+such as the yield SGI, is caught if it is above
+configMAX_API_CALL_INTERRUPT_PRIORITY. */
 #define portEND_SWITCHING_ISR( xSwitchRequired )            \
 {												            \
+	portASSERT_IF_INTERRUPT_PRIORITY_INVALID();	            \
 												            \
 	if( xSwitchRequired != pdFALSE )			            \
 	{											            \
-		ullPortYieldRequired[portGET_CORE_ID()] = pdTRUE;   \
+		xPortCoreData[portGET_CORE_ID()].ullYieldRequired = pdTRUE;   \
 	}											            \
 }
 
 #define portYIELD_FROM_ISR( x ) portEND_SWITCHING_ISR( x )
-#define portYIELD() __asm volatile ( "SVC 0" ::: "memory" )
+void vPortYield( void );
+#define portYIELD() vPortYield()
 
 /*-----------------------------------------------------------
  * Critical section control
@@ -127,32 +292,122 @@ extern uint64_t ullPortYieldRequired[];
 extern void vTaskEnterCritical( void );
 extern void vTaskExitCritical( void );
 
-#define portDISABLE_INTERRUPTS()                HwiP_disable()
-#define portENABLE_INTERRUPTS()		            HwiP_enable()
+/* Critical sections mask interrupts through the GIC CPU interface priority
+mask (ICC_PMR_EL1) rather than PSTATE.I, so interrupts with a priority above
+configMAX_API_CALL_INTERRUPT_PRIORITY (numerically lower) are never held off
+by the kernel.  Such interrupts must not call FreeRTOS API functions.  The mask
+is saved as part of the task context. */
+#define portPRIORITY_SHIFT			4
+#define portMAX_API_PRIORITY_MASK	( ( uint64_t ) configMAX_API_CALL_INTERRUPT_PRIORITY << portPRIORITY_SHIFT )
+#define portUNMASK_VALUE			( 0xFFULL )
+
+/* HwiP priority of the interrupts the port installs itself, the generic timer
+tick and the mailbox doorbell.  Both call the API, so it must not be above
+configMAX_API_CALL_INTERRUPT_PRIORITY.  The default is the lowest priority. */
+#ifndef configKERNEL_INTERRUPT_PRIORITY
+	#define configKERNEL_INTERRUPT_PRIORITY		( HwiP_MAX_PRIORITY - 1u )
+#endif
+
+/* Called by every FromISR API function, and by portEND_SWITCHING_ISR(), to
+assert that the interrupt being handled, as read from ICC_RPR_EL1, is at or
+below configMAX_API_CALL_INTERRUPT_PRIORITY. */
+#ifdef configASSERT
+	void vPortValidateInterruptPriority( void );
+	#define portASSERT_IF_INTERRUPT_PRIORITY_INVALID()	vPortValidateInterruptPriority()
+#endif
+
+/* Raise ICC_PMR_EL1 to the API mask and return its previous value. */
+static inline uint64_t ullPortSetInterruptMask( void )
+{
+    uint64_t ullPMR;
+
+    __asm volatile ( "MRS %0, S3_0_C4_C6_0      \n"	/* ICC_PMR_EL1 */
+                     "MSR S3_0_C4_C6_0, %1      \n"
+                     "DSB SY                    \n"
+                     "ISB SY                    \n"
+                     : "=&r" ( ullPMR ) : "r" ( portMAX_API_PRIORITY_MASK ) : "memory" );
+
+    return ullPMR;
+}
+
+/* Set ICC_PMR_EL1 back to a value returned by ullPortSetInterruptMask(). */
+static inline void vPortClearInterruptMask( uint64_t ullPMR )
+{
+    __asm volatile ( "MSR S3_0_C4_C6_0, %0      \n"
+                     "ISB SY                    \n"
+                     :: "r" ( ullPMR ) : "memory" );
+}
+
+#define portDISABLE_INTERRUPTS()                ullPortSetInterruptMask()
+#define portENABLE_INTERRUPTS()		            vPortClearInterruptMask( portUNMASK_VALUE )
 #define portENTER_CRITICAL()		            vTaskEnterCritical();
 #define portEXIT_CRITICAL()			            vTaskExitCritical();
 #define portSET_INTERRUPT_MASK_FROM_ISR()		({                                      \
-                                                    uint64_t x =  HwiP_disable();       \
+                                                    uint64_t x =  ullPortSetInterruptMask(); \
                                                     vTaskEnterCritical();               \
                                                     x;                                  \
                                                 })
 
 #define portCLEAR_INTERRUPT_MASK_FROM_ISR(x)	({                                  \
                                                     vTaskExitCritical();            \
-                                                    HwiP_restore(x);                \
+                                                    vPortClearInterruptMask(x);     \
                                                 })
 
+/* Set configUSE_IRQ_NESTING to 1 to let an interrupt be preempted by one of
+higher GIC priority.  The port then acknowledges the interrupt and calls the
+handler registered with HwiP itself, with PSTATE.I clear, instead of calling
+HwiP_intrHandler().  That reads the DPL's handler table (gHwiCtrl) directly,
+and port.c fails the build if the table's shape differs from what it expects.
+Anything else the DPL's HwiP_intrHandler() does per interrupt is skipped. */
+#ifndef configUSE_IRQ_NESTING
+	#define configUSE_IRQ_NESTING	0
+#endif
+
 /* Task function macros as described on the FreeRTOS.org WEB site.  These are
 not required for this port but included in case common demo code that uses these
 macros is used. */
 #define portTASK_FUNCTION_PROTO( vFunction, pvParameters )	void vFunction( void *pvParameters )
 #define portTASK_FUNCTION( vFunction, pvParameters )	void vFunction( void *pvParameters )
 
-/* Any task that uses the floating point unit MUST call vPortTaskUsesFPU()
-before any floating point instructions are executed. */
+/* configUSE_TASK_FPU_SUPPORT selects how tasks get a floating point context:
+
+1 - Any task that uses the floating point unit MUST call vPortTaskUsesFPU()
+    before any floating point instructions are executed.  Its FPU registers
+    are then saved and restored on every context switch.
+
+2 - FPU context is managed lazily.  Every task has an FPU save area of
+    portFPU_SAVE_AREA_SIZE bytes at the top of its stack, and FP/SIMD access is
+    disabled (CPACR_EL1.FPEN) each time a task is switched in.  The first
+    FP/SIMD instruction the task executes traps, the trap loads the task's
+    registers and enables access, and the registers are saved again when the
+    task is switched out.  Tasks that do not touch FP/SIMD in a time slice pay
+    nothing, and vPortTaskUsesFPU() is not needed.  The save area costs
+    portFPU_SAVE_AREA_SIZE (528) bytes of every task's stack, including tasks
+    that never use FP/SIMD, so stack sizes must allow for it.
+
+    In mode 2 the FPU registers belong to the task that is switched in, so the
+    kernel, the port and all interrupt handlers must not use FP/SIMD.  Build
+    them with -mgeneral-regs-only, as the compiler otherwise may use the SIMD
+    registers for block copies and initialisation.  An FP/SIMD access from
+    handler mode is reported through vPortFPUAccessFromHandler() and stops the
+    core.
+
+The default, 1, is set in portmacro_common.h, which portASM.S shares. */
+
+/* 32 128-bit Q registers, then FPSR and FPCR. */
+#define portFPU_SAVE_AREA_SIZE		( ( 32 * 16 ) + 16 )
+
 void vPortTaskUsesFPU( void );
 #define portTASK_USES_FLOATING_POINT() vPortTaskUsesFPU()
 
+/* 64-bit microsecond run-time counter read from the generic timer.  To use it
+for run-time stats set configRUN_TIME_COUNTER_TYPE to uint64_t and map
+portGET_RUN_TIME_COUNTER_VALUE() to ullPortGetRunTimeCounterValue() in
+FreeRTOSConfig.h.  uiPortGetRunTimeCounterValue() remains the 32-bit ClockP
+based counter. */
+void vPortConfigTimerForRunTimeStats( void );
+uint64_t ullPortGetRunTimeCounterValue( void );
+
 /* Architecture specific optimisations. */
 #ifndef configUSE_PORT_OPTIMISED_TASK_SELECTION
 	#define configUSE_PORT_OPTIMISED_TASK_SELECTION 1
@@ -168,13 +423,72 @@ void vPortTaskUsesFPU( void );
 
 #endif /* configUSE_PORT_OPTIMISED_TASK_SELECTION */
 
+/* Tick source.  By default the tick is driven by TI DPL ClockP, which calls
+vPortTimerTickHandler().  Set configUSE_GENERIC_TIMER_TICK to 1 to have the port
+drive the tick from core 0's architected generic timer instead (the EL1 virtual
+timer unless configGENERIC_TIMER_INTR_NUM says otherwise), in which case
+vPortTimerTickHandler() does nothing and ClockP's timer should be left without a
+periodic tick so it does not keep waking the core.  Tickless idle
+(configUSE_TICKLESS_IDLE) requires the generic timer tick. */
+#ifndef configUSE_GENERIC_TIMER_TICK
+	#define configUSE_GENERIC_TIMER_TICK	0
+#endif
+
+#ifndef configGENERIC_TIMER_INTR_NUM
+	#define configGENERIC_TIMER_INTR_NUM	27	/* CNTV, EL1 virtual timer PPI. */
+#endif
+
+#if ( configUSE_TICKLESS_IDLE != 0 )
+	#if ( configUSE_GENERIC_TIMER_TICK != 1 )
+		#error configUSE_TICKLESS_IDLE requires configUSE_GENERIC_TIMER_TICK to be set to 1.
+	#endif
+
+	/* In the SMP kernel the idle task calls portSUPPRESS_TICKS_AND_SLEEP()
+	between vTaskSuspendAll() and xTaskResumeAll(), holding the kernel's task
+	lock for the whole sleep, and only core 0 drives the tick.  Other cores
+	could neither schedule nor be woken for tasks that became ready, so
+	tickless idle is limited to single core builds. */
+	#if ( configNUMBER_OF_CORES != 1 )
+		#error configUSE_TICKLESS_IDLE requires configNUMBER_OF_CORES to be set to 1.
+	#endif
+
+	void vPortSuppressTicksAndSleep( TickType_t xExpectedIdleTime );
+	#define portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime ) vPortSuppressTicksAndSleep( xExpectedIdleTime )
+
+	/* Number of tickless sleeps taken since the scheduler started, and the
+	number of tick interrupts they avoided.  Each sleep still ends with one
+	wake-up, either the tick that ends it or the interrupt that cut it short,
+	so *pullTicksSuppressed is the count of wake-ups saved against a periodic
+	tick. */
+	void vPortGetTicklessStats( uint64_t *pullSleeps, uint64_t *pullTicksSuppressed );
+#endif
+
 #define portNOP() __asm volatile( "NOP" )
 #define portINLINE __inline
 #define portMEMORY_BARRIER() __asm volatile( "" ::: "memory" )
 
 /* port for SMP */
-#define portGET_CORE_ID()                   Armv8_getCoreId()
-#define portRESTORE_INTERRUPTS( ulState )   HwiP_restore ( ulState )
+
+/* Cores are numbered Aff1 * ( 1 << portCLUSTER_CORE_SHIFT ) + Aff0 from
+MPIDR_EL1, so parts with several clusters get a dense core index.  That only
+holds when every cluster has exactly 1 << portCLUSTER_CORE_SHIFT cores, and
+vPortInitCoreData() asserts that each core's index is below
+configNUMBER_OF_CORES. */
+#ifndef portCLUSTER_CORE_SHIFT
+	#define portCLUSTER_CORE_SHIFT		2
+#endif
+
+static inline BaseType_t xPortGetCoreID( void )
+{
+    uint64_t ullMPIDR;
+
+    __asm volatile ( "MRS %0, MPIDR_EL1" : "=r" ( ullMPIDR ) );
+
+    return ( BaseType_t ) ( ( ( ( ullMPIDR >> 8 ) & 0xffU ) << portCLUSTER_CORE_SHIFT ) + ( ullMPIDR & 0xffU ) );
+}
+
+#define portGET_CORE_ID()                   xPortGetCoreID()
+#define portRESTORE_INTERRUPTS( ulState )   vPortClearInterruptMask( ulState )
 #define portCHECK_IF_IN_ISR()               HwiP_inISR()
 
 /*-----------------------------------------------------------
@@ -185,7 +499,7 @@ void vPortTaskUsesFPU( void );
 #define TASK_LOCK  (1u)
 
 #define portRTOS_LOCK_COUNT 2
-#define portMAX_CORE_COUNT 2
+#define portMAX_CORE_COUNT configNUMBER_OF_CORES
 
 #define portRELEASE_ISR_LOCK( xCoreID ) vPortRecursiveLock( ( xCoreID ), ISR_LOCK, pdFALSE )
 #define portGET_ISR_LOCK( xCoreID )     vPortRecursiveLock( ( xCoreID ), ISR_LOCK, pdTRUE )
@@ -198,89 +512,208 @@ void vPortTaskUsesFPU( void );
 
 extern int32_t Signal_coreIntr( CSL_gic500_gicrRegs *pGic500GicrRegs, uint32_t coreId, uint32_t intrNum );
 
-#define portYIELD_CORE( xCoreID )   do {                        \
-                                        Signal_coreIntr((CSL_gic500_gicrRegs *) ( HWIP_GIC_BASE_ADDR + \
-                                        CSL_GIC500_GICR_CORE_CONTROL_CTLR(0U)), xCoreID, YIELD_CORE_INTERRUPT_NO); \
-                                    }while(0);
+/* The yield SGI is raised through ICC_SGI1R_EL1, whose target list addresses
+Aff0 values 0-15 within one cluster. */
+#if ( portCLUSTER_CORE_SHIFT > 4 )
+	#error portCLUSTER_CORE_SHIFT must not be more than 4.
+#endif
+
+/* Interrupt every core whose bit is set in ullCoreMask, with one SGI write
+per cluster. */
+void vPortYieldCores( uint64_t ullCoreMask );
+
+/* Interrupt one core.  While the tick is being processed the requests are
+collected and sent together by vPortYieldCores() once it is done. */
+void vPortYieldCore( BaseType_t xCoreID );
+
+#define portYIELD_CORE( xCoreID )   vPortYieldCore( xCoreID )
+
+/*-----------------------------------------------------------
+ * Inter-core mailbox
+ *----------------------------------------------------------*/
+
+/* Set configUSE_PORT_MAILBOX to 1 for single producer, single consumer
+mailboxes that pass buffer pointers between cores without the kernel locks.
+Each slot has its own cache line so the producer filling one slot and the
+consumer emptying the one before never share a line.  The producer (a task or
+an ISR) never blocks.  The consumer task blocks on its task notification, which
+the producer rings with SGI configPORT_MAILBOX_SGI only when the mailbox goes
+from empty to not empty.  Ownership of the buffer passes with the message;
+returning buffers, for example through a second mailbox, is up to the
+application. */
+#ifndef configUSE_PORT_MAILBOX
+	#define configUSE_PORT_MAILBOX		0
+#endif
+
+#ifndef configPORT_MAILBOX_SGI
+	#define configPORT_MAILBOX_SGI		1
+#endif
+
+#ifndef configPORT_MAILBOX_MAX
+	#define configPORT_MAILBOX_MAX		4
+#endif
+
+/* Index of the task notification a consumer waits on.  The default, the last
+entry of the notification array, keeps the mailbox off index 0, which the
+application and kernel objects such as stream buffers use.  With
+configTASK_NOTIFICATION_ARRAY_ENTRIES left at 1 the mailbox shares index 0, so
+a consumer task must then not wait on its notification for anything else. */
+#ifndef configPORT_MAILBOX_NOTIFY_INDEX
+	#define configPORT_MAILBOX_NOTIFY_INDEX		( configTASK_NOTIFICATION_ARRAY_ENTRIES - 1 )
+#endif
+
+typedef struct xPORT_MAILBOX_MESSAGE
+{
+	void *pvBuffer;
+	size_t xLength;
+} PortMailboxMessage_t;
+
+typedef struct xPORT_MAILBOX_SLOT
+{
+	PortMailboxMessage_t xMessage;
+} __attribute__( ( aligned( portCACHE_LINE_SIZE ) ) ) PortMailboxSlot_t;
+
+typedef struct xPORT_MAILBOX
+{
+	/* Written only by the producer. */
+	volatile uint32_t ulHead __attribute__( ( aligned( portCACHE_LINE_SIZE ) ) );
+	volatile uint32_t ulDoorbell;
+
+	/* Written only by the consumer. */
+	volatile uint32_t ulTail __attribute__( ( aligned( portCACHE_LINE_SIZE ) ) );
+	volatile uint32_t ulConsumerCore;
+	void * volatile pvConsumerTask;
+
+	/* Set once by xPortMailboxInit(). */
+	PortMailboxSlot_t *pxSlots __attribute__( ( aligned( portCACHE_LINE_SIZE ) ) );
+	uint32_t ulMask;
+} PortMailbox_t;
+
+/* Set up a mailbox over ulSlotCount slots, which must be a power of two.  Fails
+if configPORT_MAILBOX_MAX mailboxes are already in use. */
+BaseType_t xPortMailboxInit( PortMailbox_t *pxMailbox, PortMailboxSlot_t *pxSlots, uint32_t ulSlotCount );
+
+/* Producer side.  Returns pdFAIL, without blocking, if the mailbox is full. */
+BaseType_t xPortMailboxSend( PortMailbox_t *pxMailbox, const PortMailboxMessage_t *pxMessage );
+
+/* Consumer side, from a task.  Waits up to xTicksToWait for a message, on
+notification index configPORT_MAILBOX_NOTIFY_INDEX. */
+BaseType_t xPortMailboxReceive( PortMailbox_t *pxMailbox, PortMailboxMessage_t *pxMessage, TickType_t xTicksToWait );
 
 
 uint64_t Get_64(volatile uint64_t* x);
 void Set_64(volatile uint64_t* x, uint64_t value);
 
-/* Which core owns the lock */
-volatile uint64_t ucOwnedByCore[ portMAX_CORE_COUNT ];
-/* Lock count a core owns */
-volatile uint64_t ucRecursionCountByLock[ portRTOS_LOCK_COUNT ];
+/* Recursive kernel lock.  ulGate is the ticket spinlock.  ulHolder packs the
+ * owning core (core ID + 1, 0 when free) and the recursion count, and is only
+ * written by the core holding ulGate.  Another core can never read its own ID
+ * from it, so the ownership test needs no barrier. */
+#define portLOCK_OWNER_SHIFT    16u
+#define portLOCK_COUNT_MASK     0xffffu
+
+/* A core that finds the lock taken polls it up to configPORT_LOCK_SPIN_COUNT
+ * times, with an exponentially growing pause of up to portLOCK_BACKOFF_MAX
+ * YIELDs between polls, before it sleeps in WFE until the lock is released.
+ * Spinning first can hand over a briefly held lock sooner than a WFE wake-up
+ * would.  0 (the default) goes straight to WFE.  The default and
+ * portLOCK_BACKOFF_MAX are in portmacro_common.h, which portASM.S shares. */
+
+/* Set configPORT_LOCK_WAIT_BOUND_USECS to a non-zero time to time every
+ * contended acquisition of the kernel locks.  The longest wait and the number
+ * of waits over the bound are kept per lock, see vPortGetLockWaitStats(), and
+ * portLOCK_WAIT_EXCEEDED() is called, with the lock held, for each wait over
+ * the bound.  A count that keeps rising points at a critical section that is
+ * too long. */
+#ifndef configPORT_LOCK_WAIT_BOUND_USECS
+    #define configPORT_LOCK_WAIT_BOUND_USECS    0
+#endif
+
+#ifndef portLOCK_WAIT_EXCEEDED
+    #define portLOCK_WAIT_EXCEEDED( ulLockNum, xCoreID, ullWaitUsecs )
+#endif
+
+typedef struct xPORT_RECURSIVE_LOCK
+{
+    uint32_t ulGate;
+    volatile uint32_t ulHolder;
+
+    /* Written with the lock held (configPORT_LOCK_WAIT_BOUND_USECS > 0). */
+    uint32_t ulLongWaits;
+    uint64_t ullMaxWait;
+} __attribute__( ( aligned( portCACHE_LINE_SIZE ) ) ) PortRecursiveLock_t;
 
 /* Index 0 is used for ISR lock and Index 1 is used for task lock */
-uint32_t GateWord[ portRTOS_LOCK_COUNT ];
+extern PortRecursiveLock_t xPortLocks[ portRTOS_LOCK_COUNT ];
 
 int32_t GateSmp_tryLock(uint32_t* gateWord);
+void GateSmp_lock(uint32_t* gateWord);
 void GateSmp_unlock(uint32_t* gateWord);
 
+/* Takes ulGate of a lock found busy, timing the wait. */
+void vPortLockContended( PortRecursiveLock_t *pxLock, uint32_t ulLockNum, BaseType_t xCoreID );
+
+/* Number of waits for a kernel lock over configPORT_LOCK_WAIT_BOUND_USECS, and
+the longest wait, in microseconds. */
+void vPortGetLockWaitStats( uint32_t ulLockNum, uint32_t *pulLongWaits, uint64_t *pullMaxWaitUsecs );
+
+/* Clears the statistics of a lock.  Call it from inside a critical section,
+which holds both kernel locks, so it cannot race a contended acquisition. */
+void vPortResetLockWaitStats( uint32_t ulLockNum );
+
 static inline void vPortRecursiveLock(BaseType_t xCoreID, uint32_t ulLockNum, BaseType_t uxAcquire)
 {
-    uint32_t ulLockBit = 1u << ulLockNum;
+    PortRecursiveLock_t *pxLock = &xPortLocks[ ulLockNum ];
+    uint32_t ulSelf = ( ( uint32_t ) xCoreID + 1u ) << portLOCK_OWNER_SHIFT;
+    uint32_t ulHolder = pxLock->ulHolder;
 
     /* Lock acquire */
     if (uxAcquire)
     {
+        /* If the core owns the lock increment the lock count */
+        if( ( ulHolder & ~portLOCK_COUNT_MASK ) == ulSelf )
+        {
+            configASSERT( ( ulHolder & portLOCK_COUNT_MASK ) != portLOCK_COUNT_MASK );
+            pxLock->ulHolder = ulHolder + 1u;
+            return;
+        }
 
-        /* Check if spinlock is available */
-        /* If spinlock is not available check if the core owns the lock */
-        /* If the core owns the lock wait increment the lock count by the core */
-        /* If core does not own the lock wait for the spinlock */
-        if( GateSmp_tryLock( &GateWord[ulLockNum] ) != 0)
+        /* Wait for spinlock.  GateSmp_lock() has acquire semantics
+         * and waits in WFE, in ticket order. */
+        #if ( configPORT_LOCK_WAIT_BOUND_USECS > 0 )
         {
-            /* Check if the core owns the spinlock */
-            if( Get_64(&ucOwnedByCore[xCoreID]) & ulLockBit )
+            if( GateSmp_tryLock( &pxLock->ulGate ) != 0 )
             {
-                configASSERT( Get_64(&ucRecursionCountByLock[ulLockNum]) != 255u);
-                Set_64(&ucRecursionCountByLock[ulLockNum], (Get_64(&ucRecursionCountByLock[ulLockNum])+1));
-                return;
+                vPortLockContended( pxLock, ulLockNum, xCoreID );
             }
-
-            /* Preload the gate word into the cache */
-            uint32_t dummy = GateWord[ulLockNum];
-            dummy++;
-
-            /* Wait for spinlock */
-            while( GateSmp_tryLock(&GateWord[ulLockNum]) != 0);
         }
-
-         /* Add barrier to ensure lock is taken before we proceed */
-        __asm__ __volatile__ (
-            "dmb sy"
-            ::: "memory"
-        );
+        #else
+        {
+            GateSmp_lock(&pxLock->ulGate);
+        }
+        #endif
 
         /* Assert the lock count is 0 when the spinlock is free and is acquired */
-        configASSERT(Get_64(&ucRecursionCountByLock[ulLockNum]) == 0);
+        configASSERT( pxLock->ulHolder == 0u );
 
-        /* Set lock count as 1 */
-        Set_64(&ucRecursionCountByLock[ulLockNum], 1);
-        /* Set ucOwnedByCore */
-        Set_64(&ucOwnedByCore[xCoreID], (Get_64(&ucOwnedByCore[xCoreID]) | ulLockBit));
+        /* Owned by this core, lock count 1 */
+        pxLock->ulHolder = ulSelf | 1u;
     }
     /* Lock release */
     else
     {
-        /* Assert the lock is not free already */
-        configASSERT( (Get_64(&ucOwnedByCore[xCoreID]) & ulLockBit) != 0 );
-        configASSERT( Get_64(&ucRecursionCountByLock[ulLockNum]) != 0 );
+        /* Assert the lock is held by this core */
+        configASSERT( ( ulHolder & ~portLOCK_COUNT_MASK ) == ulSelf );
+        configASSERT( ( ulHolder & portLOCK_COUNT_MASK ) != 0u );
 
-        /* Reduce ucRecursionCountByLock by 1 */
-        Set_64(&ucRecursionCountByLock[ulLockNum], (Get_64(&ucRecursionCountByLock[ulLockNum]) - 1) );
-
-        if( !Get_64(&ucRecursionCountByLock[ulLockNum]) )
+        if( ( ulHolder & portLOCK_COUNT_MASK ) == 1u )
+        {
+            pxLock->ulHolder = 0u;
+            /* Release semantics: the above is visible before the lock is free */
+            GateSmp_unlock(&pxLock->ulGate);
+        }
+        else
         {
-            Set_64(&ucOwnedByCore[xCoreID], (Get_64(&ucOwnedByCore[xCoreID]) & ~ulLockBit));
-            GateSmp_unlock(&GateWord[ulLockNum]);
-            /* Add barrier to ensure lock is taken before we proceed */
-            __asm__ __volatile__ (
-                "dmb sy"
-                ::: "memory"
-            );
+            pxLock->ulHolder = ulHolder - 1u;
         }
     }
 }
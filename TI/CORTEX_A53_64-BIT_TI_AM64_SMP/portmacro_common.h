@@ -0,0 +1,65 @@
+/*
+ * FreeRTOS Kernel <DEVELOPMENT BRANCH>
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef PORTMACRO_COMMON_H
+#define PORTMACRO_COMMON_H
+
+/* Definitions shared by portmacro.h and portASM.S.  The file is included
+from assembly, so it must contain preprocessor definitions only.  Both
+include it after FreeRTOSConfig.h, so the defaults below give way to the
+application's settings. */
+
+/* Defaults of the options that portASM.S reads as well as C code.  See
+portmacro.h for what they do. */
+#ifndef configUSE_TASK_FPU_SUPPORT
+	#define configUSE_TASK_FPU_SUPPORT			1
+#endif
+
+#ifndef configPORT_LOCK_SPIN_COUNT
+	#define configPORT_LOCK_SPIN_COUNT			0
+#endif
+
+/* Longest pause, in YIELDs, between polls of a contended kernel lock. */
+#define portLOCK_BACKOFF_MAX					64
+
+/* Offsets into PortCoreData_t, the per-core data block whose address is kept
+in TPIDR_EL1.  port.c checks them against the structure. */
+#define portCORE_DATA_YIELD_REQUIRED_OFFSET		0
+#define portCORE_DATA_INTERRUPT_NESTING_OFFSET	8
+#define portCORE_DATA_FPU_CONTEXT_OFFSET		16
+#define portCORE_DATA_CORE_INDEX_OFFSET			24
+#define portCORE_DATA_FPU_SAVE_AREA_OFFSET		32
+#define portCORE_DATA_PMU_DATA_OFFSET			56
+
+/* Offsets of the raw cycle stamps written by portASM.S into PortPMUData_t,
+also checked in port.c. */
+#define portPMU_STAMP_IRQ_ENTRY_OFFSET			0
+#define portPMU_STAMP_SWITCH_START_OFFSET		8
+#define portPMU_STAMP_SWITCH_DONE_OFFSET		16
+
+#endif /* PORTMACRO_COMMON_H */
@@ -0,0 +1,581 @@
+/*
+ * FreeRTOS Kernel <DEVELOPMENT BRANCH>
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Board layer for running the A53 SMP port on the QEMU virt machine
+ * (-machine virt,gic-version=3 -cpu cortex-a53).  Implements the parts of the
+ * TI DPL that the port calls, on top of the virt GICv3, the generic timer,
+ * the PL011 UART and PSCI, so the port can be exercised without AM64
+ * hardware or the TI SDK.  See README.md.
+ */
+
+/* Standard includes. */
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include <kernel/dpl/ClockP.h>
+#include <drivers/hw_include/cslr.h>
+
+#if ( configUSE_GENERIC_TIMER_TICK != 1 )
+	#error The QEMU virt board layer has no ClockP tick, set configUSE_GENERIC_TIMER_TICK to 1.
+#endif
+
+#if ( configNUMBER_OF_CORES > BOARD_VIRT_MAX_CORES )
+	#error configNUMBER_OF_CORES is more than the QEMU virt board layer supports.
+#endif
+
+#if ( portCLUSTER_CORE_SHIFT < 3 ) && ( configNUMBER_OF_CORES > 4 )
+	/* QEMU numbers up to eight cores of a GICv3 virt machine in Aff0. */
+	#error Set portCLUSTER_CORE_SHIFT to 3 for more than four cores on QEMU virt.
+#endif
+
+/* GICD register offsets. */
+#define boardGICD_CTLR				( 0x0000UL )
+#define boardGICD_IGROUPR			( 0x0080UL )
+#define boardGICD_ISENABLER			( 0x0100UL )
+#define boardGICD_ICENABLER			( 0x0180UL )
+#define boardGICD_ISPENDR			( 0x0200UL )
+#define boardGICD_ICPENDR			( 0x0280UL )
+#define boardGICD_IPRIORITYR		( 0x0400UL )
+#define boardGICD_ICFGR				( 0x0C00UL )
+#define boardGICD_IROUTER			( 0x6000UL )
+
+/* GICD_CTLR: RWP, ARE_NS and EnableGrp1NS, for the single security state
+that QEMU virt has without secure=on. */
+#define boardGICD_CTLR_RWP			( 1UL << 31 )
+#define boardGICD_CTLR_ARE			( 1UL << 4 )
+#define boardGICD_CTLR_ENABLE_G1	( 1UL << 1 )
+
+/* GICR_WAKER. */
+#define boardGICR_WAKER_PROCESSOR_SLEEP		( 1UL << 1 )
+#define boardGICR_WAKER_CHILDREN_ASLEEP		( 1UL << 2 )
+
+/* PL011 registers and UARTFR.TXFF. */
+#define boardUART_DR				( 0x000UL )
+#define boardUART_FR				( 0x018UL )
+#define boardUART_FR_TXFF			( 1UL << 5 )
+
+/* PSCI 0.2 CPU_ON, SMC64 calling convention. */
+#define boardPSCI_CPU_ON			( 0xC4000003UL )
+
+#define boardLOG_BUFFER_SIZE		( 256u )
+
+#define boardREG32( ulAddress )		( *( volatile uint32_t * ) ( ulAddress ) )
+#define boardREG64( ulAddress )		( *( volatile uint64_t * ) ( ulAddress ) )
+
+_Static_assert( sizeof( CSL_gic500_gicrRegs_core ) == 0x20000, "GICR frame layout" );
+_Static_assert( offsetof( CSL_gic500_gicrRegs_core_sgi_ppi, ISPENDR0 ) == 0x200, "GICR frame layout" );
+_Static_assert( offsetof( CSL_gic500_gicrRegs_core_sgi_ppi, IGRPMODR0 ) == 0xD00, "GICR frame layout" );
+
+HwiP_Ctrl gHwiCtrl;
+
+/* Set by boot.S when QEMU entered at EL2 (virtualization=on), in which case
+PSCI is reached through SMC rather than HVC. */
+extern uint64_t gBoardBootedAtEL2;
+
+/* Entry point of every core, in boot.S. */
+extern void _start( void );
+
+/* BOARD_VIRT_EXC_STACK_SIZE bytes per core, in boot.S. */
+extern uint8_t gBoardExcStacks[];
+
+extern volatile uint64_t ullPortSchedularRunning;
+
+static volatile uint32_t ulLogLock = 0;
+
+static void prvGicInitDistributor( void );
+static void prvGicInitCpu( void );
+static void prvSetExceptionStack( void );
+static void prvYieldCoreISR( void *pvArgs );
+static void prvStartSecondaryCores( void );
+static void prvUartWrite( const char *pcBuffer, size_t xLength );
+
+static inline CSL_gic500_gicrRegs_core *prvGicr( uint32_t ulCoreID )
+{
+    return &( ( CSL_gic500_gicrRegs * ) BOARD_VIRT_GICR_BASE )->CORE[ ulCoreID ];
+}
+
+static inline uint32_t prvCoreID( void )
+{
+    return ( uint32_t ) portGET_CORE_ID();
+}
+
+/*-----------------------------------------------------------*/
+
+/* Called by boot.S on core 0, before main(). */
+void Board_init( void )
+{
+    HwiP_Params xHwiParams;
+    HwiP_Object xHwiObject;
+
+    vPortInitCoreData();
+    prvSetExceptionStack();
+    prvGicInitDistributor();
+    prvGicInitCpu();
+
+    /* The port raises YIELD_CORE_INTERRUPT_NO on a core to make it reschedule.
+    The handler is shared, the SGI is enabled on each core by prvGicInitCpu(). */
+    HwiP_Params_init( &xHwiParams );
+    xHwiParams.intNum = YIELD_CORE_INTERRUPT_NO;
+    xHwiParams.callback = prvYieldCoreISR;
+    xHwiParams.priority = configKERNEL_INTERRUPT_PRIORITY;
+    ( void ) HwiP_construct( &xHwiObject, &xHwiParams );
+
+    prvStartSecondaryCores();
+}
+/*-----------------------------------------------------------*/
+
+/* Called by boot.S on every other core.  Waits for core 0 to start the
+scheduler, which creates this core's idle task, then joins in. */
+void Board_secondaryMain( void )
+{
+    vPortInitCoreData();
+    prvSetExceptionStack();
+    prvGicInitCpu();
+
+    while( ullPortSchedularRunning == pdFALSE )
+    {
+        __asm volatile ( "YIELD" ::: "memory" );
+    }
+
+    ( void ) xPortStartScheduler();
+}
+/*-----------------------------------------------------------*/
+
+static void prvGicWaitForRWP( void )
+{
+    while( ( boardREG32( BOARD_VIRT_GICD_BASE + boardGICD_CTLR ) & boardGICD_CTLR_RWP ) != 0 )
+    {
+    }
+}
+
+static void prvGicInitDistributor( void )
+{
+    uint32_t x;
+
+    boardREG32( BOARD_VIRT_GICD_BASE + boardGICD_CTLR ) = 0;
+    prvGicWaitForRWP();
+
+    /* All SPIs disabled, group 1, level triggered and at the lowest usable
+    priority until HwiP_construct() configures them. */
+    for( x = HWIP_GICD_SGI_PPI_INTR_ID_MAX; x < HwiP_MAX_INTERRUPTS; x += 32u )
+    {
+        boardREG32( BOARD_VIRT_GICD_BASE + boardGICD_ICENABLER + ( x / 8u ) ) = 0xFFFFFFFFu;
+        boardREG32( BOARD_VIRT_GICD_BASE + boardGICD_ICPENDR + ( x / 8u ) ) = 0xFFFFFFFFu;
+        boardREG32( BOARD_VIRT_GICD_BASE + boardGICD_IGROUPR + ( x / 8u ) ) = 0xFFFFFFFFu;
+    }
+
+    for( x = HWIP_GICD_SGI_PPI_INTR_ID_MAX; x < HwiP_MAX_INTERRUPTS; x += 16u )
+    {
+        boardREG32( BOARD_VIRT_GICD_BASE + boardGICD_ICFGR + ( x / 4u ) ) = 0;
+    }
+
+    for( x = HWIP_GICD_SGI_PPI_INTR_ID_MAX; x < HwiP_MAX_INTERRUPTS; x++ )
+    {
+        *( volatile uint8_t * ) ( BOARD_VIRT_GICD_BASE + boardGICD_IPRIORITYR + x ) = ( uint8_t ) ( ( HwiP_MAX_PRIORITY - 1u ) << portPRIORITY_SHIFT );
+    }
+
+    boardREG32( BOARD_VIRT_GICD_BASE + boardGICD_CTLR ) = boardGICD_CTLR_ARE | boardGICD_CTLR_ENABLE_G1;
+    prvGicWaitForRWP();
+}
+
+/* Wake this core's redistributor and enable its CPU interface. */
+static void prvGicInitCpu( void )
+{
+    CSL_gic500_gicrRegs_core *pxGicr = prvGicr( prvCoreID() );
+    uint32_t x;
+
+    pxGicr->CONTROL.WAKER &= ~boardGICR_WAKER_PROCESSOR_SLEEP;
+
+    while( ( pxGicr->CONTROL.WAKER & boardGICR_WAKER_CHILDREN_ASLEEP ) != 0 )
+    {
+    }
+
+    pxGicr->SGI_PPI.ICENABLER0 = 0xFFFFFFFFu;
+    pxGicr->SGI_PPI.ICPENDR0 = 0xFFFFFFFFu;
+    pxGicr->SGI_PPI.IGROUPR0 = 0xFFFFFFFFu;
+    pxGicr->SGI_PPI.IGRPMODR0 = 0;
+
+    for( x = 0; x < HWIP_GICD_SGI_PPI_INTR_ID_MAX; x++ )
+    {
+        pxGicr->SGI_PPI.IPRIORITYR[ x ] = ( uint8_t ) ( ( HwiP_MAX_PRIORITY - 1u ) << portPRIORITY_SHIFT );
+    }
+
+    /* Any SGI or PPI with a handler, such as the yield SGI, is enabled on
+    every core. */
+    for( x = 0; x < HWIP_GICD_SGI_PPI_INTR_ID_MAX; x++ )
+    {
+        if( gHwiCtrl.isr[ x ] != NULL )
+        {
+            pxGicr->SGI_PPI.ISENABLER0 = 1u << x;
+        }
+    }
+
+    /* ICC_SRE_EL1.SRE is set by boot.S.  No priority grouping, all
+    priorities unmasked and group 1 enabled. */
+    __asm volatile ( "MSR S3_0_C12_C12_3, %0" :: "r" ( 0ULL ) : "memory" );				/* ICC_BPR1_EL1 */
+    __asm volatile ( "MSR S3_0_C4_C6_0, %0" :: "r" ( portUNMASK_VALUE ) : "memory" );		/* ICC_PMR_EL1 */
+    __asm volatile ( "MSR S3_0_C12_C12_7, %0\n\tISB SY" :: "r" ( 1ULL ) : "memory" );	/* ICC_IGRPEN1_EL1 */
+}
+
+static void prvSetExceptionStack( void )
+{
+    #if ( configUSE_PORT_EXC_STACK_MONITOR == 1 )
+    {
+        vPortSetExceptionStack( &gBoardExcStacks[ prvCoreID() * BOARD_VIRT_EXC_STACK_SIZE ], BOARD_VIRT_EXC_STACK_SIZE );
+    }
+    #endif
+}
+
+static void prvYieldCoreISR( void *pvArgs )
+{
+    ( void ) pvArgs;
+
+    portYIELD_FROM_ISR( pdTRUE );
+}
+
+static void prvStartSecondaryCores( void )
+{
+    register uint64_t x0 __asm__( "x0" );
+    register uint64_t x1 __asm__( "x1" );
+    register uint64_t x2 __asm__( "x2" );
+    register uint64_t x3 __asm__( "x3" );
+    uint32_t ulCoreID;
+
+    for( ulCoreID = 1; ulCoreID < configNUMBER_OF_CORES; ulCoreID++ )
+    {
+        x0 = boardPSCI_CPU_ON;
+        x1 = ( uint64_t ) ulCoreID;		/* MPIDR affinity, Aff0 only. */
+        x2 = ( uint64_t ) _start;
+        x3 = 0;
+
+        if( gBoardBootedAtEL2 != 0 )
+        {
+            __asm volatile ( "SMC #0" : "+r" ( x0 ) : "r" ( x1 ), "r" ( x2 ), "r" ( x3 ) : "memory" );
+        }
+        else
+        {
+            __asm volatile ( "HVC #0" : "+r" ( x0 ) : "r" ( x1 ), "r" ( x2 ), "r" ( x3 ) : "memory" );
+        }
+
+        configASSERT( x0 == 0 );
+    }
+}
+/*-----------------------------------------------------------*/
+
+void HwiP_Params_init( HwiP_Params *params )
+{
+    params->intNum = 0;
+    params->callback = NULL;
+    params->args = NULL;
+    params->priority = ( uint8_t ) ( HwiP_MAX_PRIORITY - 1u );
+    params->isPulse = 0;
+}
+
+int32_t HwiP_construct( HwiP_Object *obj, HwiP_Params *params )
+{
+    uint32_t ulIntNum = params->intNum;
+    uint8_t ucPriority = ( uint8_t ) ( params->priority << portPRIORITY_SHIFT );
+    uint32_t ulConfigShift = ( ulIntNum % 16u ) * 2u;
+    uint32_t ulConfig = ( params->isPulse != 0 ) ? 2u : 0u;
+    uint64_t ullMPIDR;
+    CSL_gic500_gicrRegs_core *pxGicr;
+    volatile uint32_t *pulICFGR;
+
+    if( ( ulIntNum >= HwiP_MAX_INTERRUPTS ) || ( params->priority >= HwiP_MAX_PRIORITY ) )
+    {
+        return SystemP_FAILURE;
+    }
+
+    obj->intNum = ulIntNum;
+
+    ( void ) HwiP_disableInt( ulIntNum );
+
+    gHwiCtrl.isrArgs[ ulIntNum ] = params->args;
+    gHwiCtrl.isr[ ulIntNum ] = params->callback;
+
+    if( ulIntNum < HWIP_GICD_SGI_PPI_INTR_ID_MAX )
+    {
+        pxGicr = prvGicr( prvCoreID() );
+        pxGicr->SGI_PPI.IPRIORITYR[ ulIntNum ] = ucPriority;
+
+        /* SGIs are always edge triggered. */
+        if( ulIntNum >= 16u )
+        {
+            pulICFGR = &pxGicr->SGI_PPI.ICFGR1;
+            *pulICFGR = ( *pulICFGR & ~( 3u << ulConfigShift ) ) | ( ulConfig << ulConfigShift );
+        }
+    }
+    else
+    {
+        *( volatile uint8_t * ) ( BOARD_VIRT_GICD_BASE + boardGICD_IPRIORITYR + ulIntNum ) = ucPriority;
+
+        pulICFGR = &boardREG32( BOARD_VIRT_GICD_BASE + boardGICD_ICFGR + ( ( ulIntNum / 16u ) * 4u ) );
+        *pulICFGR = ( *pulICFGR & ~( 3u << ulConfigShift ) ) | ( ulConfig << ulConfigShift );
+
+        /* Route to the calling core. */
+        __asm volatile ( "MRS %0, MPIDR_EL1" : "=r" ( ullMPIDR ) );
+        boardREG64( BOARD_VIRT_GICD_BASE + boardGICD_IROUTER + ( ulIntNum * 8u ) ) = ullMPIDR & 0xFF00FFFFFFULL;
+    }
+
+    if( params->callback != NULL )
+    {
+        HwiP_enableInt( ulIntNum );
+    }
+
+    return SystemP_SUCCESS;
+}
+
+void HwiP_destruct( HwiP_Object *obj )
+{
+    ( void ) HwiP_disableInt( obj->intNum );
+
+    gHwiCtrl.isr[ obj->intNum ] = NULL;
+    gHwiCtrl.isrArgs[ obj->intNum ] = NULL;
+}
+
+void HwiP_enableInt( uint32_t intNum )
+{
+    if( intNum < HWIP_GICD_SGI_PPI_INTR_ID_MAX )
+    {
+        prvGicr( prvCoreID() )->SGI_PPI.ISENABLER0 = 1u << intNum;
+    }
+    else if( intNum < HwiP_MAX_INTERRUPTS )
+    {
+        boardREG32( BOARD_VIRT_GICD_BASE + boardGICD_ISENABLER + ( ( intNum / 32u ) * 4u ) ) = 1u << ( intNum % 32u );
+    }
+}
+
+uint32_t HwiP_disableInt( uint32_t intNum )
+{
+    uint32_t ulMask = 1u << ( intNum % 32u );
+    uint32_t ulWasEnabled = 0;
+
+    if( intNum < HWIP_GICD_SGI_PPI_INTR_ID_MAX )
+    {
+        CSL_gic500_gicrRegs_core *pxGicr = prvGicr( prvCoreID() );
+
+        ulWasEnabled = ( ( pxGicr->SGI_PPI.ISENABLER0 & ulMask ) != 0 ) ? 1u : 0u;
+        pxGicr->SGI_PPI.ICENABLER0 = ulMask;
+    }
+    else if( intNum < HwiP_MAX_INTERRUPTS )
+    {
+        ulWasEnabled = ( ( boardREG32( BOARD_VIRT_GICD_BASE + boardGICD_ISENABLER + ( ( intNum / 32u ) * 4u ) ) & ulMask ) != 0 ) ? 1u : 0u;
+        boardREG32( BOARD_VIRT_GICD_BASE + boardGICD_ICENABLER + ( ( intNum / 32u ) * 4u ) ) = ulMask;
+    }
+
+    __asm volatile ( "DSB SY" ::: "memory" );
+
+    return ulWasEnabled;
+}
+
+void HwiP_restoreInt( uint32_t intNum, uint32_t oldIntState )
+{
+    if( oldIntState != 0 )
+    {
+        HwiP_enableInt( intNum );
+    }
+}
+
+void HwiP_clearInt( uint32_t intNum )
+{
+    if( intNum < HWIP_GICD_SGI_PPI_INTR_ID_MAX )
+    {
+        prvGicr( prvCoreID() )->SGI_PPI.ICPENDR0 = 1u << intNum;
+    }
+    else if( intNum < HwiP_MAX_INTERRUPTS )
+    {
+        boardREG32( BOARD_VIRT_GICD_BASE + boardGICD_ICPENDR + ( ( intNum / 32u ) * 4u ) ) = 1u << ( intNum % 32u );
+    }
+}
+
+void HwiP_post( uint32_t intNum )
+{
+    if( intNum < HWIP_GICD_SGI_PPI_INTR_ID_MAX )
+    {
+        prvGicr( prvCoreID() )->SGI_PPI.ISPENDR0 = 1u << intNum;
+    }
+    else if( intNum < HwiP_MAX_INTERRUPTS )
+    {
+        boardREG32( BOARD_VIRT_GICD_BASE + boardGICD_ISPENDR + ( ( intNum / 32u ) * 4u ) ) = 1u << ( intNum % 32u );
+    }
+}
+
+uintptr_t HwiP_disable( void )
+{
+    uint64_t ullDAIF;
+
+    __asm volatile ( "MRS %0, DAIF\n\tMSR DAIFSET, #2\n\tISB SY" : "=r" ( ullDAIF ) :: "memory" );
+
+    return ( uintptr_t ) ullDAIF;
+}
+
+void HwiP_enable( void )
+{
+    __asm volatile ( "MSR DAIFCLR, #2\n\tISB SY" ::: "memory" );
+}
+
+void HwiP_restore( uintptr_t oldIntState )
+{
+    __asm volatile ( "MSR DAIF, %0\n\tISB SY" :: "r" ( ( uint64_t ) oldIntState ) : "memory" );
+}
+
+/* Tasks and main() run on SP_EL0, exception handlers on SP_EL1. */
+uint32_t HwiP_inISR( void )
+{
+    uint64_t ullSPSel;
+
+    __asm volatile ( "MRS %0, SPSel" : "=r" ( ullSPSel ) );
+
+    return ( uint32_t ) ( ullSPSel & 1u );
+}
+
+void HwiP_intrHandler( void )
+{
+    uint64_t ullIAR;
+    uint32_t ulIntNum;
+
+    __asm volatile ( "MRS %0, S3_0_C12_C12_0" : "=r" ( ullIAR ) :: "memory" );	/* ICC_IAR1_EL1 */
+    ulIntNum = ( uint32_t ) ( ullIAR & 0xFFFFFFU );
+
+    if( ulIntNum < HwiP_MAX_INTERRUPTS )
+    {
+        if( gHwiCtrl.isr[ ulIntNum ] != NULL )
+        {
+            gHwiCtrl.isr[ ulIntNum ]( gHwiCtrl.isrArgs[ ulIntNum ] );
+        }
+
+        __asm volatile ( "MSR S3_0_C12_C12_1, %0\n\tISB SY" :: "r" ( ullIAR ) : "memory" );	/* ICC_EOIR1_EL1 */
+    }
+    else
+    {
+        gHwiCtrl.spuriousIRQCount++;
+    }
+}
+
+void HwiP_defaultHandler( uint64_t elr )
+{
+    uint64_t ullESR, ullFAR;
+
+    __asm volatile ( "MRS %0, ESR_EL1" : "=r" ( ullESR ) );
+    __asm volatile ( "MRS %0, FAR_EL1" : "=r" ( ullFAR ) );
+
+    DebugP_log( "Unhandled exception on core %u: ESR 0x%llx ELR 0x%llx FAR 0x%llx\r\n",
+                ( unsigned ) prvCoreID(), ( unsigned long long ) ullESR,
+                ( unsigned long long ) elr, ( unsigned long long ) ullFAR );
+
+    _DebugP_assertNoLog( 0 );
+}
+/*-----------------------------------------------------------*/
+
+uint64_t ClockP_getTimeUsec( void )
+{
+    return ullPortGetRunTimeCounterValue();
+}
+/*-----------------------------------------------------------*/
+
+/* The port's idle hooks call the DPL's task load accounting, which this layer
+does not provide. */
+void vApplicationLoadHook( void )
+{
+}
+/*-----------------------------------------------------------*/
+
+static void prvUartWrite( const char *pcBuffer, size_t xLength )
+{
+    size_t x;
+
+    for( x = 0; x < xLength; x++ )
+    {
+        while( ( boardREG32( BOARD_VIRT_UART_BASE + boardUART_FR ) & boardUART_FR_TXFF ) != 0 )
+        {
+        }
+
+        boardREG32( BOARD_VIRT_UART_BASE + boardUART_DR ) = ( uint32_t ) pcBuffer[ x ];
+    }
+}
+
+void DebugP_log( const char *format, ... )
+{
+    char cBuffer[ boardLOG_BUFFER_SIZE ];
+    va_list xArgs;
+    int iLength;
+    uintptr_t xInterruptState;
+
+    va_start( xArgs, format );
+    iLength = vsnprintf( cBuffer, sizeof( cBuffer ), format, xArgs );
+    va_end( xArgs );
+
+    if( iLength > 0 )
+    {
+        if( ( size_t ) iLength >= sizeof( cBuffer ) )
+        {
+            iLength = ( int ) sizeof( cBuffer ) - 1;
+        }
+
+        /* One line at a time across cores. */
+        xInterruptState = HwiP_disable();
+
+        while( __atomic_exchange_n( &ulLogLock, 1u, __ATOMIC_ACQUIRE ) != 0 )
+        {
+        }
+
+        prvUartWrite( cBuffer, ( size_t ) iLength );
+
+        __atomic_store_n( &ulLogLock, 0u, __ATOMIC_RELEASE );
+
+        HwiP_restore( xInterruptState );
+    }
+}
+
+void _DebugP_assertNoLog( int32_t expression )
+{
+    if( expression == 0 )
+    {
+        ( void ) HwiP_disable();
+
+        for( ;; )
+        {
+            __asm volatile ( "WFE" );
+        }
+    }
+}
+
+void _DebugP_assert( int32_t expression, const char *file, const char *function, int32_t line, const char *expressionString )
+{
+    if( expression == 0 )
+    {
+        DebugP_log( "ASSERT: %s (%s:%s:%d)\r\n", expressionString, file, function, ( int ) line );
+        _DebugP_assertNoLog( 0 );
+    }
+}
@@ -0,0 +1,94 @@
+/*
+ * FreeRTOS Kernel <DEVELOPMENT BRANCH>
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Configuration shared by the measurement demos in this directory.  Settings a
+ * demo needs changed are guarded so they can be given on the command line, see
+ * README.md.
+ */
+
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+#include <kernel/dpl/DebugP.h>
+
+#ifndef configNUMBER_OF_CORES
+	#define configNUMBER_OF_CORES					4
+#endif
+
+#define configUSE_PREEMPTION						1
+#define configTICK_RATE_HZ							1000
+#define configMAX_PRIORITIES						16
+#define configMINIMAL_STACK_SIZE					1024
+#define configMAX_TASK_NAME_LEN						16
+#define configIDLE_SHOULD_YIELD						1
+#define configUSE_TASK_NOTIFICATIONS				1
+#define configUSE_MUTEXES							1
+#define configUSE_RECURSIVE_MUTEXES					1
+#define configUSE_COUNTING_SEMAPHORES				1
+#define configUSE_TIMERS							0
+#define configUSE_IDLE_HOOK							0
+#define configUSE_MINIMAL_IDLE_HOOK					0
+#define configUSE_PASSIVE_IDLE_HOOK					0
+#ifndef configUSE_TICK_HOOK
+	#define configUSE_TICK_HOOK						0
+#endif
+#define configCHECK_FOR_STACK_OVERFLOW				2
+
+#define configSUPPORT_STATIC_ALLOCATION				0
+#define configSUPPORT_DYNAMIC_ALLOCATION			1
+#define configTOTAL_HEAP_SIZE						( 4 * 1024 * 1024 )
+
+#if ( configNUMBER_OF_CORES > 1 )
+	#define configRUN_MULTIPLE_PRIORITIES			1
+	#define configUSE_CORE_AFFINITY					1
+#endif
+
+/* The virt machine has no ClockP timer, see ../README.md. */
+#define configUSE_GENERIC_TIMER_TICK				1
+#define configGENERIC_TIMER_INTR_NUM				27
+#define configMAX_API_CALL_INTERRUPT_PRIORITY		8
+
+/* Time contended kernel lock acquisitions, reported by lock_stress_main.c. */
+#ifndef configPORT_LOCK_WAIT_BOUND_USECS
+	#define configPORT_LOCK_WAIT_BOUND_USECS		50
+#endif
+
+/* Tickless idle is limited to single core builds by the port. */
+#ifndef configUSE_TICKLESS_IDLE
+	#define configUSE_TICKLESS_IDLE					0
+#endif
+
+#define INCLUDE_vTaskDelay							1
+#define INCLUDE_vTaskDelayUntil						1
+#define INCLUDE_xTaskGetCurrentTaskHandle			1
+#define INCLUDE_vTaskSuspend						1
+
+#define configASSERT( x )							DebugP_assert( x )
+
+#endif /* FREERTOS_CONFIG_H */
@@ -0,0 +1,220 @@
+/*
+ * FreeRTOS Kernel <DEVELOPMENT BRANCH>
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Interrupt latency measurement.  The time from raising an SGI to the entry of
+ * its handler is measured twice: with the core otherwise idle, and with the
+ * SGI raised from inside a lower priority handler that then stays busy for
+ * demoBUSY_USECS.  Without configUSE_IRQ_NESTING the second figure includes
+ * the rest of the lower priority handler; with it, it should be close to the
+ * first.
+ *
+ * Build once as is and once with -DconfigUSE_IRQ_NESTING=1 and compare.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include <kernel/dpl/HwiP.h>
+#include <kernel/dpl/DebugP.h>
+
+/* Both SGIs are above the tick.  Neither handler calls the API, so their
+priorities are not limited by configMAX_API_CALL_INTERRUPT_PRIORITY. */
+#define demoLOW_SGI				8U
+#define demoHIGH_SGI			9U
+#define demoLOW_PRIORITY		14U
+#define demoHIGH_PRIORITY		9U
+
+#define demoBUSY_USECS			50U
+#define demoSAMPLES				1000U
+
+typedef struct xDEMO_LATENCY
+{
+    uint64_t ullMin;
+    uint64_t ullMax;
+    uint64_t ullSum;
+    uint64_t ullCount;
+} DemoLatency_t;
+
+static volatile uint64_t ullRaisedAt;
+static uint64_t ullBusyCounts;
+static DemoLatency_t *volatile pxCurrentLatency;
+static DemoLatency_t xIdleLatency = { UINT64_MAX, 0, 0, 0 };
+static DemoLatency_t xNestedLatency = { UINT64_MAX, 0, 0, 0 };
+
+static HwiP_Object xLowHwiObject;
+static HwiP_Object xHighHwiObject;
+
+static void prvLatencyTask( void *pvParameters );
+
+/*-----------------------------------------------------------*/
+
+static inline uint64_t prvReadCounter( void )
+{
+    uint64_t ullCount;
+
+    __asm volatile ( "ISB SY\n\tMRS %0, CNTVCT_EL0" : "=r" ( ullCount ) :: "memory" );
+
+    return ullCount;
+}
+
+static uint64_t prvCountsToNsecs( uint64_t ullCounts )
+{
+    uint64_t ullFrequency;
+
+    __asm volatile ( "MRS %0, CNTFRQ_EL0" : "=r" ( ullFrequency ) );
+
+    return ( ullCounts * 1000000000ULL ) / ullFrequency;
+}
+/*-----------------------------------------------------------*/
+
+int main( void )
+{
+    ( void ) xTaskCreate( prvLatencyTask, "Latency", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY + 1, NULL );
+
+    vTaskStartScheduler();
+
+    for( ;; )
+    {
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvLowISR( void *pvArgs )
+{
+    uint64_t ullEnd;
+
+    ( void ) pvArgs;
+
+    ullRaisedAt = prvReadCounter();
+    HwiP_post( demoHIGH_SGI );
+
+    ullEnd = ullRaisedAt + ullBusyCounts;
+
+    while( prvReadCounter() < ullEnd )
+    {
+    }
+}
+
+static void prvHighISR( void *pvArgs )
+{
+    uint64_t ullLatency = prvReadCounter() - ullRaisedAt;
+    DemoLatency_t *pxLatency = pxCurrentLatency;
+
+    ( void ) pvArgs;
+
+    if( ullLatency < pxLatency->ullMin )
+    {
+        pxLatency->ullMin = ullLatency;
+    }
+
+    if( ullLatency > pxLatency->ullMax )
+    {
+        pxLatency->ullMax = ullLatency;
+    }
+
+    pxLatency->ullSum += ullLatency;
+    pxLatency->ullCount++;
+}
+/*-----------------------------------------------------------*/
+
+static void prvPrintLatency( const char *pcName, const DemoLatency_t *pxLatency )
+{
+    DebugP_log( "%-22s min %6llu ns  avg %6llu ns  max %6llu ns  (%llu samples)\r\n",
+                pcName,
+                ( unsigned long long ) prvCountsToNsecs( pxLatency->ullMin ),
+                ( unsigned long long ) prvCountsToNsecs( pxLatency->ullSum / pxLatency->ullCount ),
+                ( unsigned long long ) prvCountsToNsecs( pxLatency->ullMax ),
+                ( unsigned long long ) pxLatency->ullCount );
+}
+
+static void prvLatencyTask( void *pvParameters )
+{
+    HwiP_Params xHwiParams;
+    uint64_t ullFrequency;
+    uint32_t ulSample;
+    int32_t lStatus;
+
+    ( void ) pvParameters;
+
+    /* SGIs are banked per core, so install, raise and take them all on core 0. */
+    #if ( configNUMBER_OF_CORES > 1 )
+    {
+        vTaskCoreAffinitySet( NULL, 1U << 0 );
+    }
+    #endif
+
+    __asm volatile ( "MRS %0, CNTFRQ_EL0" : "=r" ( ullFrequency ) );
+    ullBusyCounts = ( ullFrequency * demoBUSY_USECS ) / 1000000ULL;
+
+    HwiP_Params_init( &xHwiParams );
+    xHwiParams.intNum = demoLOW_SGI;
+    xHwiParams.callback = prvLowISR;
+    xHwiParams.priority = demoLOW_PRIORITY;
+    lStatus = HwiP_construct( &xLowHwiObject, &xHwiParams );
+    configASSERT( lStatus == SystemP_SUCCESS );
+
+    HwiP_Params_init( &xHwiParams );
+    xHwiParams.intNum = demoHIGH_SGI;
+    xHwiParams.callback = prvHighISR;
+    xHwiParams.priority = demoHIGH_PRIORITY;
+    lStatus = HwiP_construct( &xHighHwiObject, &xHwiParams );
+    configASSERT( lStatus == SystemP_SUCCESS );
+
+    /* Raised from the task, with no other interrupt active. */
+    pxCurrentLatency = &xIdleLatency;
+
+    for( ulSample = 0; ulSample < demoSAMPLES; ulSample++ )
+    {
+        ullRaisedAt = prvReadCounter();
+        HwiP_post( demoHIGH_SGI );
+        vTaskDelay( 1 );
+    }
+
+    /* Raised from inside the busy lower priority handler. */
+    pxCurrentLatency = &xNestedLatency;
+
+    for( ulSample = 0; ulSample < demoSAMPLES; ulSample++ )
+    {
+        HwiP_post( demoLOW_SGI );
+        vTaskDelay( 1 );
+    }
+
+    DebugP_log( "configUSE_IRQ_NESTING = %d\r\n", configUSE_IRQ_NESTING );
+    prvPrintLatency( "idle core", &xIdleLatency );
+    prvPrintLatency( "behind a busy handler", &xNestedLatency );
+
+    for( ;; )
+    {
+        vTaskDelay( portMAX_DELAY );
+    }
+}
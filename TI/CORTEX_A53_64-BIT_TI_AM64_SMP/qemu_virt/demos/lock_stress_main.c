@@ -0,0 +1,273 @@
+/*
+ * FreeRTOS Kernel <DEVELOPMENT BRANCH>
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Kernel lock contention stress test.  One task per core enters and leaves
+ * critical sections, some nested and some inside vTaskSuspendAll(), as fast
+ * as it can, so every acquisition of the kernel locks is contended.  Each
+ * pass increments a shared counter without atomics, so a lock that lets two
+ * cores in at once shows up as a count mismatch at the end.
+ *
+ * The test runs in phases.  In each phase every pass holds the lock for one
+ * of the times in ulHoldUsecs[], busy waiting on CNTVCT_EL0, so the waits of
+ * the other cores grow from the bare cost of the lock to well past
+ * configPORT_LOCK_WAIT_BOUND_USECS.  After each phase the passes per core and
+ * the lock wait statistics from vPortGetLockWaitStats() are printed, and the
+ * statistics are cleared for the next phase.
+ *
+ * Build with different -DconfigPORT_LOCK_SPIN_COUNT values to compare the
+ * spin-then-WFE policies.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include <kernel/dpl/DebugP.h>
+
+#if ( configNUMBER_OF_CORES < 2 )
+	#error This demo needs more than one core.
+#endif
+
+#if ( configPORT_LOCK_WAIT_BOUND_USECS == 0 )
+	#error Build this demo with configPORT_LOCK_WAIT_BOUND_USECS above 0.
+#endif
+
+#define demoPHASE_TIME_MS		1000U
+#define demoWORKER_PRIORITY		( tskIDLE_PRIORITY + 1 )
+#define demoCONTROL_PRIORITY	( tskIDLE_PRIORITY + 2 )
+
+/* How long each pass holds the lock, one phase per entry. */
+static const uint32_t ulHoldUsecs[] = { 0U, 10U, 100U, 1000U };
+
+#define demoPHASES				( sizeof( ulHoldUsecs ) / sizeof( ulHoldUsecs[ 0 ] ) )
+
+/* Only updated inside a critical section or with the scheduler suspended,
+both of which hold the task lock. */
+static volatile uint64_t ullSharedCount;
+
+/* Each written by one worker. */
+static volatile uint64_t ullPasses[ configNUMBER_OF_CORES ];
+
+/* Set by the control task to start phase ulPhase - 1, 0 before the first. */
+static volatile uint32_t ulPhase;
+static volatile uint32_t ulStop;
+static volatile uint32_t ulWorkersDone;
+
+static void prvWorkerTask( void *pvParameters );
+static void prvControlTask( void *pvParameters );
+
+/*-----------------------------------------------------------*/
+
+static inline uint64_t prvReadCounter( void )
+{
+    uint64_t ullCount;
+
+    __asm volatile ( "ISB SY\n\tMRS %0, CNTVCT_EL0" : "=r" ( ullCount ) :: "memory" );
+
+    return ullCount;
+}
+
+static inline void prvHold( uint64_t ullCounts )
+{
+    uint64_t ullEnd;
+
+    if( ullCounts != 0 )
+    {
+        ullEnd = prvReadCounter() + ullCounts;
+
+        while( prvReadCounter() < ullEnd )
+        {
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+int main( void )
+{
+    UBaseType_t uxCore;
+
+    for( uxCore = 0; uxCore < configNUMBER_OF_CORES; uxCore++ )
+    {
+        ( void ) xTaskCreateAffinitySet( prvWorkerTask, "Worker", configMINIMAL_STACK_SIZE, ( void * ) uxCore,
+                                         demoWORKER_PRIORITY, ( UBaseType_t ) 1U << uxCore, NULL );
+    }
+
+    ( void ) xTaskCreate( prvControlTask, "Control", configMINIMAL_STACK_SIZE, NULL, demoCONTROL_PRIORITY, NULL );
+
+    vTaskStartScheduler();
+
+    for( ;; )
+    {
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvWorkerTask( void *pvParameters )
+{
+    UBaseType_t uxCore = ( UBaseType_t ) pvParameters;
+    uint32_t ulLastPhase = 0;
+    uint64_t ullPass, ullHoldCounts, ullFrequency;
+
+    __asm volatile ( "MRS %0, CNTFRQ_EL0" : "=r" ( ullFrequency ) );
+
+    for( ;; )
+    {
+        while( ulPhase == ulLastPhase )
+        {
+            vTaskDelay( 1 );
+        }
+
+        ulLastPhase = ulPhase;
+        ullHoldCounts = ( ullFrequency * ulHoldUsecs[ ulLastPhase - 1U ] ) / 1000000ULL;
+        ullPass = 0;
+
+        while( ulStop == 0 )
+        {
+            if( ( ullPass & 0xFU ) == 0 )
+            {
+                /* Task lock only, held across the increment. */
+                vTaskSuspendAll();
+                {
+                    ullSharedCount++;
+                    prvHold( ullHoldCounts );
+                }
+                ( void ) xTaskResumeAll();
+            }
+            else
+            {
+                /* Task and ISR locks, taken recursively every other pass. */
+                taskENTER_CRITICAL();
+                {
+                    if( ( ullPass & 1U ) != 0 )
+                    {
+                        taskENTER_CRITICAL();
+                        ullSharedCount++;
+                        taskEXIT_CRITICAL();
+                    }
+                    else
+                    {
+                        ullSharedCount++;
+                    }
+
+                    prvHold( ullHoldCounts );
+                }
+                taskEXIT_CRITICAL();
+            }
+
+            ullPass++;
+            ullPasses[ uxCore ] = ullPass;
+        }
+
+        __atomic_add_fetch( &ulWorkersDone, 1U, __ATOMIC_SEQ_CST );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvControlTask( void *pvParameters )
+{
+    static const char * const pcLockNames[ portRTOS_LOCK_COUNT ] = { "ISR lock", "task lock" };
+    uint64_t ullTotal, ullMaxWaitUsecs;
+    uint32_t ulLongWaits, ulLock, ulThisPhase;
+    UBaseType_t uxCore;
+    BaseType_t xAllOk = pdTRUE;
+
+    ( void ) pvParameters;
+
+    DebugP_log( "configPORT_LOCK_SPIN_COUNT = %d, bound %u us, %u ms per phase\r\n", configPORT_LOCK_SPIN_COUNT,
+                ( unsigned ) configPORT_LOCK_WAIT_BOUND_USECS, demoPHASE_TIME_MS );
+
+    for( ulThisPhase = 0; ulThisPhase < demoPHASES; ulThisPhase++ )
+    {
+        /* The workers are all waiting for the next phase. */
+        taskENTER_CRITICAL();
+        {
+            for( ulLock = 0; ulLock < portRTOS_LOCK_COUNT; ulLock++ )
+            {
+                vPortResetLockWaitStats( ulLock );
+            }
+
+            ullSharedCount = 0;
+
+            for( uxCore = 0; uxCore < configNUMBER_OF_CORES; uxCore++ )
+            {
+                ullPasses[ uxCore ] = 0;
+            }
+
+            ulStop = 0;
+            ulWorkersDone = 0;
+        }
+        taskEXIT_CRITICAL();
+
+        __atomic_store_n( &ulPhase, ulThisPhase + 1U, __ATOMIC_SEQ_CST );
+
+        vTaskDelay( pdMS_TO_TICKS( demoPHASE_TIME_MS ) );
+
+        __atomic_store_n( &ulStop, 1U, __ATOMIC_SEQ_CST );
+
+        while( ulWorkersDone < configNUMBER_OF_CORES )
+        {
+            vTaskDelay( 1 );
+        }
+
+        DebugP_log( "hold %u us:\r\n", ( unsigned ) ulHoldUsecs[ ulThisPhase ] );
+
+        ullTotal = 0;
+
+        for( uxCore = 0; uxCore < configNUMBER_OF_CORES; uxCore++ )
+        {
+            DebugP_log( "  core %u: %llu passes\r\n", ( unsigned ) uxCore, ( unsigned long long ) ullPasses[ uxCore ] );
+            ullTotal += ullPasses[ uxCore ];
+        }
+
+        DebugP_log( "  total %llu, shared counter %llu: %s\r\n", ( unsigned long long ) ullTotal,
+                    ( unsigned long long ) ullSharedCount, ( ullTotal == ullSharedCount ) ? "ok" : "MISMATCH" );
+
+        for( ulLock = 0; ulLock < portRTOS_LOCK_COUNT; ulLock++ )
+        {
+            vPortGetLockWaitStats( ulLock, &ulLongWaits, &ullMaxWaitUsecs );
+            DebugP_log( "  %s: %u waits over %u us, longest %llu us\r\n", pcLockNames[ ulLock ], ( unsigned ) ulLongWaits,
+                        ( unsigned ) configPORT_LOCK_WAIT_BOUND_USECS, ( unsigned long long ) ullMaxWaitUsecs );
+        }
+
+        if( ullTotal != ullSharedCount )
+        {
+            xAllOk = pdFALSE;
+        }
+    }
+
+    configASSERT( xAllOk != pdFALSE );
+
+    for( ;; )
+    {
+        vTaskDelay( portMAX_DELAY );
+    }
+}
@@ -0,0 +1,220 @@
+/*
+ * FreeRTOS Kernel <DEVELOPMENT BRANCH>
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Inter-core mailbox throughput.  A producer task on core 0 passes
+ * demoMESSAGES numbered messages to a consumer task on core 1, first through a
+ * port mailbox and then through a queue of the same depth.  The consumer
+ * checks that every message arrives, in order, and the rate of each is
+ * printed in messages per second, from the producer sending the first message
+ * to the consumer taking the last.
+ *
+ * Build with -DconfigUSE_PORT_MAILBOX=1.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+#include <kernel/dpl/DebugP.h>
+
+#if ( configNUMBER_OF_CORES < 2 )
+	#error This demo needs more than one core.
+#endif
+
+#if ( configUSE_PORT_MAILBOX == 0 )
+	#error Build this demo with configUSE_PORT_MAILBOX set to 1.
+#endif
+
+#define demoMESSAGES			100000U
+#define demoDEPTH				16U
+#define demoPRODUCER_CORE		0U
+#define demoCONSUMER_CORE		1U
+#define demoTASK_PRIORITY		( tskIDLE_PRIORITY + 1 )
+
+/* The sequence number travels in xLength; pvBuffer is not used. */
+static PortMailbox_t xMailbox;
+static PortMailboxSlot_t xSlots[ demoDEPTH ];
+static QueueHandle_t xQueue;
+
+/* Given by the consumer when it has taken the last message of a run, with
+the time it did so in ullEndCount. */
+static SemaphoreHandle_t xRunDone;
+static volatile uint64_t ullEndCount;
+static volatile uint32_t ulOutOfOrder;
+
+static void prvProducerTask( void *pvParameters );
+static void prvConsumerTask( void *pvParameters );
+
+/*-----------------------------------------------------------*/
+
+static inline uint64_t prvReadCounter( void )
+{
+    uint64_t ullCount;
+
+    __asm volatile ( "ISB SY\n\tMRS %0, CNTVCT_EL0" : "=r" ( ullCount ) :: "memory" );
+
+    return ullCount;
+}
+/*-----------------------------------------------------------*/
+
+int main( void )
+{
+    BaseType_t xStatus;
+
+    xStatus = xPortMailboxInit( &xMailbox, xSlots, demoDEPTH );
+    configASSERT( xStatus == pdPASS );
+
+    xQueue = xQueueCreate( demoDEPTH, sizeof( PortMailboxMessage_t ) );
+    configASSERT( xQueue != NULL );
+
+    xRunDone = xSemaphoreCreateBinary();
+    configASSERT( xRunDone != NULL );
+
+    ( void ) xTaskCreateAffinitySet( prvConsumerTask, "Consumer", configMINIMAL_STACK_SIZE, NULL,
+                                     demoTASK_PRIORITY, 1U << demoCONSUMER_CORE, NULL );
+    ( void ) xTaskCreateAffinitySet( prvProducerTask, "Producer", configMINIMAL_STACK_SIZE, NULL,
+                                     demoTASK_PRIORITY, 1U << demoPRODUCER_CORE, NULL );
+
+    vTaskStartScheduler();
+
+    for( ;; )
+    {
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvCheckSequence( const PortMailboxMessage_t *pxMessage, size_t xExpected )
+{
+    if( pxMessage->xLength != xExpected )
+    {
+        ulOutOfOrder++;
+    }
+}
+
+static void prvConsumerTask( void *pvParameters )
+{
+    PortMailboxMessage_t xMessage;
+    size_t x;
+    BaseType_t xStatus;
+
+    ( void ) pvParameters;
+
+    for( x = 0; x < demoMESSAGES; x++ )
+    {
+        xStatus = xPortMailboxReceive( &xMailbox, &xMessage, portMAX_DELAY );
+        configASSERT( xStatus == pdPASS );
+        prvCheckSequence( &xMessage, x );
+    }
+
+    ullEndCount = prvReadCounter();
+    ( void ) xSemaphoreGive( xRunDone );
+
+    for( x = 0; x < demoMESSAGES; x++ )
+    {
+        xStatus = xQueueReceive( xQueue, &xMessage, portMAX_DELAY );
+        configASSERT( xStatus == pdPASS );
+        prvCheckSequence( &xMessage, x );
+    }
+
+    ullEndCount = prvReadCounter();
+    ( void ) xSemaphoreGive( xRunDone );
+
+    for( ;; )
+    {
+        vTaskDelay( portMAX_DELAY );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvReport( const char *pcName, uint64_t ullStartCount )
+{
+    uint64_t ullFrequency, ullCounts;
+
+    ( void ) xSemaphoreTake( xRunDone, portMAX_DELAY );
+
+    __asm volatile ( "MRS %0, CNTFRQ_EL0" : "=r" ( ullFrequency ) );
+    ullCounts = ullEndCount - ullStartCount;
+
+    DebugP_log( "%-8s %u messages in %llu us, %llu messages/s, %u out of order\r\n", pcName, demoMESSAGES,
+                ( unsigned long long ) ( ( ullCounts * 1000000ULL ) / ullFrequency ),
+                ( unsigned long long ) ( ( ( uint64_t ) demoMESSAGES * ullFrequency ) / ullCounts ),
+                ( unsigned ) ulOutOfOrder );
+
+    configASSERT( ulOutOfOrder == 0 );
+}
+
+static void prvProducerTask( void *pvParameters )
+{
+    PortMailboxMessage_t xMessage = { NULL, 0 };
+    uint64_t ullStartCount;
+    size_t x;
+
+    ( void ) pvParameters;
+
+    /* Give the consumer time to block, so both runs start from empty. */
+    vTaskDelay( pdMS_TO_TICKS( 10 ) );
+
+    ullStartCount = prvReadCounter();
+
+    for( x = 0; x < demoMESSAGES; x++ )
+    {
+        xMessage.xLength = x;
+
+        /* The mailbox never blocks the producer, so retry while it is full. */
+        while( xPortMailboxSend( &xMailbox, &xMessage ) != pdPASS )
+        {
+        }
+    }
+
+    prvReport( "mailbox", ullStartCount );
+
+    vTaskDelay( pdMS_TO_TICKS( 10 ) );
+
+    ullStartCount = prvReadCounter();
+
+    for( x = 0; x < demoMESSAGES; x++ )
+    {
+        xMessage.xLength = x;
+        ( void ) xQueueSend( xQueue, &xMessage, portMAX_DELAY );
+    }
+
+    prvReport( "queue", ullStartCount );
+
+    DebugP_log( "done\r\n" );
+
+    for( ;; )
+    {
+        vTaskDelay( portMAX_DELAY );
+    }
+}
@@ -0,0 +1,221 @@
+/*
+ * FreeRTOS Kernel <DEVELOPMENT BRANCH>
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Core scaling and core index check.  A fixed CPU-bound workload of
+ * demoCHUNKS chunks is split evenly between one task per core, and the time
+ * from the start to the last task finishing gives the throughput in chunks
+ * per second.  Before each chunk every task checks, with interrupts masked,
+ * that TPIDR_EL1 points at the xPortCoreData[] entry of the core it is pinned
+ * to and that the entry's ullCoreIndex matches the MPIDR-derived
+ * portGET_CORE_ID().
+ *
+ * Build and run three times, with -DconfigNUMBER_OF_CORES=1, 2 and 4 and the
+ * matching -smp, and compare the throughput.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include <kernel/dpl/DebugP.h>
+
+#define demoCHUNKS				4096U
+#define demoCHUNK_ITERATIONS	20000U
+#define demoWORKER_PRIORITY		( tskIDLE_PRIORITY + 1 )
+#define demoCONTROL_PRIORITY	( tskIDLE_PRIORITY + 2 )
+
+#if ( ( demoCHUNKS % configNUMBER_OF_CORES ) != 0 )
+	#error demoCHUNKS must divide evenly between the cores.
+#endif
+
+static TaskHandle_t xControlTask;
+
+/* Each written by one worker. */
+static volatile uint64_t ullResults[ configNUMBER_OF_CORES ];
+static volatile uint64_t ullEndCounts[ configNUMBER_OF_CORES ];
+static volatile uint32_t ulIndexMismatches[ configNUMBER_OF_CORES ];
+
+static volatile uint32_t ulStart;
+static volatile uint32_t ulWorkersDone;
+
+static void prvWorkerTask( void *pvParameters );
+static void prvControlTask( void *pvParameters );
+
+/*-----------------------------------------------------------*/
+
+static inline uint64_t prvReadCounter( void )
+{
+    uint64_t ullCount;
+
+    __asm volatile ( "ISB SY\n\tMRS %0, CNTVCT_EL0" : "=r" ( ullCount ) :: "memory" );
+
+    return ullCount;
+}
+/*-----------------------------------------------------------*/
+
+int main( void )
+{
+    UBaseType_t uxCore;
+
+    for( uxCore = 0; uxCore < configNUMBER_OF_CORES; uxCore++ )
+    {
+        #if ( configNUMBER_OF_CORES > 1 )
+        {
+            ( void ) xTaskCreateAffinitySet( prvWorkerTask, "Worker", configMINIMAL_STACK_SIZE, ( void * ) uxCore,
+                                             demoWORKER_PRIORITY, ( UBaseType_t ) 1U << uxCore, NULL );
+        }
+        #else
+        {
+            ( void ) xTaskCreate( prvWorkerTask, "Worker", configMINIMAL_STACK_SIZE, ( void * ) uxCore,
+                                  demoWORKER_PRIORITY, NULL );
+        }
+        #endif
+    }
+
+    ( void ) xTaskCreate( prvControlTask, "Control", configMINIMAL_STACK_SIZE, NULL, demoCONTROL_PRIORITY, &xControlTask );
+
+    vTaskStartScheduler();
+
+    for( ;; )
+    {
+    }
+}
+/*-----------------------------------------------------------*/
+
+/* Returns pdTRUE if this core's per-core data is the entry for uxCore. */
+static BaseType_t prvCheckCoreIndex( UBaseType_t uxCore )
+{
+    PortCoreData_t *pxCoreData;
+    BaseType_t xCoreID, xReturn;
+
+    taskENTER_CRITICAL();
+    {
+        __asm volatile ( "MRS %0, TPIDR_EL1" : "=r" ( pxCoreData ) );
+        xCoreID = portGET_CORE_ID();
+
+        xReturn = ( ( xCoreID == ( BaseType_t ) uxCore ) &&
+                    ( pxCoreData == &xPortCoreData[ xCoreID ] ) &&
+                    ( pxCoreData->ullCoreIndex == ( uint64_t ) xCoreID ) ) ? pdTRUE : pdFALSE;
+    }
+    taskEXIT_CRITICAL();
+
+    return xReturn;
+}
+
+static void prvWorkerTask( void *pvParameters )
+{
+    UBaseType_t uxCore = ( UBaseType_t ) pvParameters;
+    uint64_t ullState = 0x9E3779B97F4A7C15ULL + uxCore;
+    uint32_t ulChunk, ulIteration;
+
+    /* Spin rather than delay so every worker starts at once.  The control
+    task is of higher priority, so it still runs. */
+    while( ulStart == 0 )
+    {
+    }
+
+    for( ulChunk = 0; ulChunk < ( demoCHUNKS / configNUMBER_OF_CORES ); ulChunk++ )
+    {
+        if( prvCheckCoreIndex( uxCore ) == pdFALSE )
+        {
+            ulIndexMismatches[ uxCore ]++;
+        }
+
+        /* xorshift64, so the work cannot be folded away. */
+        for( ulIteration = 0; ulIteration < demoCHUNK_ITERATIONS; ulIteration++ )
+        {
+            ullState ^= ullState << 13;
+            ullState ^= ullState >> 7;
+            ullState ^= ullState << 17;
+        }
+    }
+
+    ullResults[ uxCore ] = ullState;
+    ullEndCounts[ uxCore ] = prvReadCounter();
+
+    if( __atomic_add_fetch( &ulWorkersDone, 1U, __ATOMIC_SEQ_CST ) == configNUMBER_OF_CORES )
+    {
+        ( void ) xTaskNotifyGive( xControlTask );
+    }
+
+    for( ;; )
+    {
+        vTaskDelay( portMAX_DELAY );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvControlTask( void *pvParameters )
+{
+    uint64_t ullStartCount, ullEndCount = 0, ullFrequency, ullUsecs;
+    uint32_t ulMismatches = 0;
+    UBaseType_t uxCore;
+
+    ( void ) pvParameters;
+
+    /* Let every worker reach its core first. */
+    vTaskDelay( pdMS_TO_TICKS( 10 ) );
+
+    ullStartCount = prvReadCounter();
+    __atomic_store_n( &ulStart, 1U, __ATOMIC_SEQ_CST );
+
+    ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+
+    __asm volatile ( "MRS %0, CNTFRQ_EL0" : "=r" ( ullFrequency ) );
+
+    for( uxCore = 0; uxCore < configNUMBER_OF_CORES; uxCore++ )
+    {
+        if( ullEndCounts[ uxCore ] > ullEndCount )
+        {
+            ullEndCount = ullEndCounts[ uxCore ];
+        }
+
+        DebugP_log( "core %u: %u chunks, done after %llu us, result %016llx, %u index mismatches\r\n",
+                    ( unsigned ) uxCore, ( unsigned ) ( demoCHUNKS / configNUMBER_OF_CORES ),
+                    ( unsigned long long ) ( ( ( ullEndCounts[ uxCore ] - ullStartCount ) * 1000000ULL ) / ullFrequency ),
+                    ( unsigned long long ) ullResults[ uxCore ], ( unsigned ) ulIndexMismatches[ uxCore ] );
+        ulMismatches += ulIndexMismatches[ uxCore ];
+    }
+
+    ullUsecs = ( ( ullEndCount - ullStartCount ) * 1000000ULL ) / ullFrequency;
+
+    DebugP_log( "%d cores: %u chunks in %llu us, %llu chunks/s\r\n", configNUMBER_OF_CORES, demoCHUNKS,
+                ( unsigned long long ) ullUsecs,
+                ( unsigned long long ) ( ( ( uint64_t ) demoCHUNKS * 1000000ULL ) / ( ullUsecs != 0 ? ullUsecs : 1 ) ) );
+
+    configASSERT( ulMismatches == 0 );
+
+    for( ;; )
+    {
+        vTaskDelay( portMAX_DELAY );
+    }
+}
@@ -0,0 +1,107 @@
+/*
+ * FreeRTOS Kernel <DEVELOPMENT BRANCH>
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Tickless idle measurement.  One task sleeps for configurable periods with
+ * nothing else running, which is the case tickless idle exists for, and then
+ * reports how many of the tick interrupts that a periodic tick would have
+ * taken were avoided, from vPortGetTicklessStats().
+ *
+ * Build as a single core image with -DconfigNUMBER_OF_CORES=1
+ * -DconfigUSE_TICKLESS_IDLE=1 and run with -smp 1.
+ */
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include <kernel/dpl/DebugP.h>
+
+#if ( configUSE_TICKLESS_IDLE == 0 )
+	#error Build this demo with configUSE_TICKLESS_IDLE set to 1.
+#endif
+
+/* Sleep periods, in ticks, and the number of sleeps for each. */
+#define demoSLEEPS_PER_PERIOD		20U
+
+static const TickType_t xSleepPeriods[] = { 2, 10, 100, 1000 };
+
+static void prvTicklessTask( void *pvParameters );
+
+/*-----------------------------------------------------------*/
+
+int main( void )
+{
+    ( void ) xTaskCreate( prvTicklessTask, "Tickless", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY + 1, NULL );
+
+    vTaskStartScheduler();
+
+    for( ;; )
+    {
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvTicklessTask( void *pvParameters )
+{
+    uint64_t ullSleepsBefore, ullSuppressedBefore, ullSleeps, ullSuppressed;
+    TickType_t xStart, xElapsed;
+    uint32_t ulPeriod, ulSleep;
+
+    ( void ) pvParameters;
+
+    DebugP_log( "period  ticks  sleeps  ticks avoided\r\n" );
+
+    for( ulPeriod = 0; ulPeriod < ( sizeof( xSleepPeriods ) / sizeof( xSleepPeriods[ 0 ] ) ); ulPeriod++ )
+    {
+        vPortGetTicklessStats( &ullSleepsBefore, &ullSuppressedBefore );
+        xStart = xTaskGetTickCount();
+
+        for( ulSleep = 0; ulSleep < demoSLEEPS_PER_PERIOD; ulSleep++ )
+        {
+            vTaskDelay( xSleepPeriods[ ulPeriod ] );
+        }
+
+        xElapsed = xTaskGetTickCount() - xStart;
+        vPortGetTicklessStats( &ullSleeps, &ullSuppressed );
+        ullSleeps -= ullSleepsBefore;
+        ullSuppressed -= ullSuppressedBefore;
+
+        DebugP_log( "%6lu  %5lu  %6llu  %13llu (%llu%%)\r\n",
+                    ( unsigned long ) xSleepPeriods[ ulPeriod ], ( unsigned long ) xElapsed,
+                    ( unsigned long long ) ullSleeps, ( unsigned long long ) ullSuppressed,
+                    ( unsigned long long ) ( ( ullSuppressed * 100ULL ) / ( xElapsed != 0 ? xElapsed : 1 ) ) );
+    }
+
+    DebugP_log( "done\r\n" );
+
+    for( ;; )
+    {
+        vTaskDelay( portMAX_DELAY );
+    }
+}
@@ -0,0 +1,271 @@
+/*
+ * FreeRTOS Kernel <DEVELOPMENT BRANCH>
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Cross-core wake-up latency.  A task on core 0 wakes tasks blocked on the
+ * other cores, and each woken task measures the time from the wake-up to its
+ * first instruction, from CNTVCT_EL0:
+ *
+ * notify - the core 0 task records the time and gives the task a
+ *          notification, which sends it one yield SGI.
+ * tick   - the tasks all block until the same tick, so one tick readies a
+ *          task for every other core and the tick handler sends the yield
+ *          requests it collected as one multicast SGI.  The time is recorded
+ *          by the tick hook.
+ *
+ * The minimum, average and maximum latency of each core are printed.
+ *
+ * Build with -DconfigUSE_TICK_HOOK=1.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include <kernel/dpl/DebugP.h>
+
+#if ( configNUMBER_OF_CORES < 2 )
+	#error This demo needs more than one core.
+#endif
+
+#if ( configUSE_TICK_HOOK == 0 )
+	#error Build this demo with configUSE_TICK_HOOK set to 1.
+#endif
+
+#define demoSAMPLES				500U
+#define demoTICK_PERIOD			4U
+#define demoWAITER_PRIORITY		( tskIDLE_PRIORITY + 1 )
+#define demoWAKER_PRIORITY		( tskIDLE_PRIORITY + 2 )
+
+#define demoMODE_NOTIFY			0U
+#define demoMODE_TICK			1U
+
+typedef struct xDEMO_LATENCY
+{
+    uint64_t ullMin;
+    uint64_t ullMax;
+    uint64_t ullSum;
+    uint64_t ullCount;
+} DemoLatency_t;
+
+/* Waiter n runs on core n, there is none for core 0. */
+static TaskHandle_t xWaiters[ configNUMBER_OF_CORES ];
+static volatile uint64_t ullGivenAt[ configNUMBER_OF_CORES ];
+static DemoLatency_t xNotifyLatency[ configNUMBER_OF_CORES ];
+static DemoLatency_t xTickLatency[ configNUMBER_OF_CORES ];
+
+/* Written by the tick hook on every demoTICK_PERIOD'th tick. */
+static volatile uint64_t ullTickAt;
+static volatile TickType_t xTickAtTick;
+
+static volatile uint32_t ulMode = demoMODE_NOTIFY;
+static volatile uint32_t ulWaitersDone;
+
+static void prvWaiterTask( void *pvParameters );
+static void prvWakerTask( void *pvParameters );
+
+/*-----------------------------------------------------------*/
+
+static inline uint64_t prvReadCounter( void )
+{
+    uint64_t ullCount;
+
+    __asm volatile ( "ISB SY\n\tMRS %0, CNTVCT_EL0" : "=r" ( ullCount ) :: "memory" );
+
+    return ullCount;
+}
+
+static uint64_t prvCountsToNsecs( uint64_t ullCounts )
+{
+    uint64_t ullFrequency;
+
+    __asm volatile ( "MRS %0, CNTFRQ_EL0" : "=r" ( ullFrequency ) );
+
+    return ( ullCounts * 1000000000ULL ) / ullFrequency;
+}
+
+static void prvRecordLatency( DemoLatency_t *pxLatency, uint64_t ullLatency )
+{
+    if( ullLatency < pxLatency->ullMin )
+    {
+        pxLatency->ullMin = ullLatency;
+    }
+
+    if( ullLatency > pxLatency->ullMax )
+    {
+        pxLatency->ullMax = ullLatency;
+    }
+
+    pxLatency->ullSum += ullLatency;
+    pxLatency->ullCount++;
+}
+/*-----------------------------------------------------------*/
+
+int main( void )
+{
+    UBaseType_t uxCore;
+
+    for( uxCore = 1; uxCore < configNUMBER_OF_CORES; uxCore++ )
+    {
+        xNotifyLatency[ uxCore ].ullMin = UINT64_MAX;
+        xTickLatency[ uxCore ].ullMin = UINT64_MAX;
+
+        ( void ) xTaskCreateAffinitySet( prvWaiterTask, "Waiter", configMINIMAL_STACK_SIZE, ( void * ) uxCore,
+                                         demoWAITER_PRIORITY, ( UBaseType_t ) 1U << uxCore, &xWaiters[ uxCore ] );
+    }
+
+    ( void ) xTaskCreateAffinitySet( prvWakerTask, "Waker", configMINIMAL_STACK_SIZE, NULL,
+                                     demoWAKER_PRIORITY, 1U << 0, NULL );
+
+    vTaskStartScheduler();
+
+    for( ;; )
+    {
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vApplicationTickHook( void )
+{
+    TickType_t xTick = xTaskGetTickCountFromISR();
+
+    if( ( xTick % demoTICK_PERIOD ) == 0 )
+    {
+        ullTickAt = prvReadCounter();
+        xTickAtTick = xTick;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvWaiterTask( void *pvParameters )
+{
+    UBaseType_t uxCore = ( UBaseType_t ) pvParameters;
+    TickType_t xPreviousWake;
+    uint64_t ullNow;
+    uint32_t ulSample;
+
+    while( ulMode == demoMODE_NOTIFY )
+    {
+        ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+        ullNow = prvReadCounter();
+        prvRecordLatency( &xNotifyLatency[ uxCore ], ullNow - ullGivenAt[ uxCore ] );
+    }
+
+    /* Every waiter wakes on the same multiples of demoTICK_PERIOD. */
+    xPreviousWake = ( xTaskGetTickCount() / demoTICK_PERIOD ) * demoTICK_PERIOD;
+
+    for( ulSample = 0; ulSample < demoSAMPLES; ulSample++ )
+    {
+        vTaskDelayUntil( &xPreviousWake, demoTICK_PERIOD );
+        ullNow = prvReadCounter();
+
+        /* Skip a wake-up that was late enough to miss its tick's stamp. */
+        if( xTickAtTick == xPreviousWake )
+        {
+            prvRecordLatency( &xTickLatency[ uxCore ], ullNow - ullTickAt );
+        }
+    }
+
+    __atomic_add_fetch( &ulWaitersDone, 1U, __ATOMIC_SEQ_CST );
+
+    for( ;; )
+    {
+        vTaskDelay( portMAX_DELAY );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvPrintLatency( const char *pcName, UBaseType_t uxCore, const DemoLatency_t *pxLatency )
+{
+    if( pxLatency->ullCount == 0 )
+    {
+        DebugP_log( "%-6s core %u: no samples\r\n", pcName, ( unsigned ) uxCore );
+        return;
+    }
+
+    DebugP_log( "%-6s core %u: min %6llu ns  avg %6llu ns  max %6llu ns  (%llu samples)\r\n",
+                pcName, ( unsigned ) uxCore,
+                ( unsigned long long ) prvCountsToNsecs( pxLatency->ullMin ),
+                ( unsigned long long ) prvCountsToNsecs( pxLatency->ullSum / pxLatency->ullCount ),
+                ( unsigned long long ) prvCountsToNsecs( pxLatency->ullMax ),
+                ( unsigned long long ) pxLatency->ullCount );
+}
+
+static void prvWakerTask( void *pvParameters )
+{
+    UBaseType_t uxCore;
+    uint32_t ulSample;
+
+    ( void ) pvParameters;
+
+    /* Let the waiters block first. */
+    vTaskDelay( pdMS_TO_TICKS( 10 ) );
+
+    for( ulSample = 0; ulSample < demoSAMPLES; ulSample++ )
+    {
+        /* The waiters go on to the tick phase after the last notification. */
+        if( ulSample == ( demoSAMPLES - 1U ) )
+        {
+            __atomic_store_n( &ulMode, demoMODE_TICK, __ATOMIC_SEQ_CST );
+        }
+
+        for( uxCore = 1; uxCore < configNUMBER_OF_CORES; uxCore++ )
+        {
+            ullGivenAt[ uxCore ] = prvReadCounter();
+            ( void ) xTaskNotifyGive( xWaiters[ uxCore ] );
+        }
+
+        /* Long enough for every waiter to block again. */
+        vTaskDelay( 1 );
+    }
+
+    while( ulWaitersDone < ( configNUMBER_OF_CORES - 1U ) )
+    {
+        vTaskDelay( 1 );
+    }
+
+    for( uxCore = 1; uxCore < configNUMBER_OF_CORES; uxCore++ )
+    {
+        prvPrintLatency( "notify", uxCore, &xNotifyLatency[ uxCore ] );
+    }
+
+    for( uxCore = 1; uxCore < configNUMBER_OF_CORES; uxCore++ )
+    {
+        prvPrintLatency( "tick", uxCore, &xTickLatency[ uxCore ] );
+    }
+
+    DebugP_log( "done\r\n" );
+
+    for( ;; )
+    {
+        vTaskDelay( portMAX_DELAY );
+    }
+}
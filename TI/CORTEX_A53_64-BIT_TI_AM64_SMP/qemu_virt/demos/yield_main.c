@@ -0,0 +1,297 @@
+/*
+ * FreeRTOS Kernel <DEVELOPMENT BRANCH>
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Voluntary yield throughput.  Tasks of equal priority call taskYIELD() in a
+ * tight loop, in two phases:
+ *
+ * alone  - one task per core, so each yield selects the same task again and
+ *          returns through portRESTORE_SAME_CONTEXT.
+ * paired - two tasks per core, so each yield switches to the other task and
+ *          returns through portRESTORE_CONTEXT.
+ *
+ * Across every yield each task holds sentinels in X19-X28 and D8-D15, the
+ * registers a call to vPortYield() must preserve, and checks them afterwards.
+ * The yields per second of each phase and any sentinel mismatches are
+ * printed.  Build with -DconfigUSE_PORT_PMU_TRACE=1 to also print the PMU
+ * statistics of each phase; switch_restore should be clearly shorter in the
+ * alone phase.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include <kernel/dpl/DebugP.h>
+
+#if ( configNUMBER_OF_CORES < 2 )
+	#error This demo needs more than one core.
+#endif
+
+#define demoPHASE_TIME_MS		1000U
+#define demoWORKER_PRIORITY		( tskIDLE_PRIORITY + 1 )
+#define demoCONTROL_PRIORITY	( tskIDLE_PRIORITY + 2 )
+
+/* X19-X28, then D8-D15. */
+#define demoSENTINELS			18U
+
+/* Workers 0 to configNUMBER_OF_CORES - 1 run in both phases, the rest only
+in the paired phase.  Worker n runs on core n % configNUMBER_OF_CORES. */
+#define demoWORKERS				( 2 * configNUMBER_OF_CORES )
+
+/* Each written by one worker. */
+static volatile uint64_t ullYields[ demoWORKERS ];
+static volatile uint64_t ullMismatches[ demoWORKERS ];
+
+static volatile uint32_t ulRunning;
+static volatile uint32_t ulWorkersStopped;
+
+static void prvWorkerTask( void *pvParameters );
+static void prvControlTask( void *pvParameters );
+
+/*-----------------------------------------------------------*/
+
+/* Loads the sentinels derived from ullSeed, yields, and stores what the
+registers hold afterwards in pullSeen.  The registers are saved and restored
+around this, so the compiler sees only the call's scratch registers used. */
+static void prvYieldWithSentinels( uint64_t ullSeed, uint64_t *pullSeen )
+{
+    __asm volatile
+    (
+        "STP    X19, X20, [SP, #-0x10]!     \n"
+        "STP    X21, X22, [SP, #-0x10]!     \n"
+        "STP    X23, X24, [SP, #-0x10]!     \n"
+        "STP    X25, X26, [SP, #-0x10]!     \n"
+        "STP    X27, X28, [SP, #-0x10]!     \n"
+        "STP    D8, D9, [SP, #-0x10]!       \n"
+        "STP    D10, D11, [SP, #-0x10]!     \n"
+        "STP    D12, D13, [SP, #-0x10]!     \n"
+        "STP    D14, D15, [SP, #-0x10]!     \n"
+        "STR    %1, [SP, #-0x10]!           \n"
+        "MOV    X9, %0                      \n"
+        "ADD    X19, X9, #1                 \n"
+        "ADD    X20, X9, #2                 \n"
+        "ADD    X21, X9, #3                 \n"
+        "ADD    X22, X9, #4                 \n"
+        "ADD    X23, X9, #5                 \n"
+        "ADD    X24, X9, #6                 \n"
+        "ADD    X25, X9, #7                 \n"
+        "ADD    X26, X9, #8                 \n"
+        "ADD    X27, X9, #9                 \n"
+        "ADD    X28, X9, #10                \n"
+        "ADD    X10, X9, #11                \n"
+        "FMOV   D8, X10                     \n"
+        "ADD    X10, X9, #12                \n"
+        "FMOV   D9, X10                     \n"
+        "ADD    X10, X9, #13                \n"
+        "FMOV   D10, X10                    \n"
+        "ADD    X10, X9, #14                \n"
+        "FMOV   D11, X10                    \n"
+        "ADD    X10, X9, #15                \n"
+        "FMOV   D12, X10                    \n"
+        "ADD    X10, X9, #16                \n"
+        "FMOV   D13, X10                    \n"
+        "ADD    X10, X9, #17                \n"
+        "FMOV   D14, X10                    \n"
+        "ADD    X10, X9, #18                \n"
+        "FMOV   D15, X10                    \n"
+        "BL     vPortYield                  \n"
+        "LDR    X9, [SP], #0x10             \n"
+        "STP    X19, X20, [X9, #0x00]       \n"
+        "STP    X21, X22, [X9, #0x10]       \n"
+        "STP    X23, X24, [X9, #0x20]       \n"
+        "STP    X25, X26, [X9, #0x30]       \n"
+        "STP    X27, X28, [X9, #0x40]       \n"
+        "STP    D8, D9, [X9, #0x50]         \n"
+        "STP    D10, D11, [X9, #0x60]       \n"
+        "STP    D12, D13, [X9, #0x70]       \n"
+        "STP    D14, D15, [X9, #0x80]       \n"
+        "LDP    D14, D15, [SP], #0x10       \n"
+        "LDP    D12, D13, [SP], #0x10       \n"
+        "LDP    D10, D11, [SP], #0x10       \n"
+        "LDP    D8, D9, [SP], #0x10         \n"
+        "LDP    X27, X28, [SP], #0x10       \n"
+        "LDP    X25, X26, [SP], #0x10       \n"
+        "LDP    X23, X24, [SP], #0x10       \n"
+        "LDP    X21, X22, [SP], #0x10       \n"
+        "LDP    X19, X20, [SP], #0x10       \n"
+        :
+        : "r" ( ullSeed ), "r" ( pullSeen )
+        : "x0", "x1", "x2", "x3", "x4", "x5", "x6", "x7", "x8", "x9", "x10", "x11", "x12", "x13", "x14",
+          "x15", "x16", "x17", "x18", "x30", "v0", "v1", "v2", "v3", "v4", "v5", "v6", "v7", "v16", "v17",
+          "v18", "v19", "v20", "v21", "v22", "v23", "v24", "v25", "v26", "v27", "v28", "v29", "v30", "v31",
+          "cc", "memory"
+    );
+}
+/*-----------------------------------------------------------*/
+
+int main( void )
+{
+    UBaseType_t uxWorker;
+
+    for( uxWorker = 0; uxWorker < configNUMBER_OF_CORES; uxWorker++ )
+    {
+        ( void ) xTaskCreateAffinitySet( prvWorkerTask, "Yield", configMINIMAL_STACK_SIZE, ( void * ) uxWorker,
+                                         demoWORKER_PRIORITY, ( UBaseType_t ) 1U << uxWorker, NULL );
+    }
+
+    ( void ) xTaskCreate( prvControlTask, "Control", configMINIMAL_STACK_SIZE, NULL, demoCONTROL_PRIORITY, NULL );
+
+    vTaskStartScheduler();
+
+    for( ;; )
+    {
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvWorkerTask( void *pvParameters )
+{
+    UBaseType_t uxWorker = ( UBaseType_t ) pvParameters;
+    uint64_t ullSeen[ demoSENTINELS ];
+    uint64_t ullSeed, ullYield;
+    uint32_t x;
+
+    portTASK_USES_FLOATING_POINT();
+
+    for( ;; )
+    {
+        while( ulRunning == 0 )
+        {
+            vTaskDelay( 1 );
+        }
+
+        ullYield = 0;
+
+        while( ulRunning != 0 )
+        {
+            ullSeed = ( ( uint64_t ) uxWorker << 48 ) | ( ( ullYield & 0xFFFFFFFFULL ) << 8 );
+            prvYieldWithSentinels( ullSeed, ullSeen );
+
+            for( x = 0; x < demoSENTINELS; x++ )
+            {
+                if( ullSeen[ x ] != ( ullSeed + x + 1U ) )
+                {
+                    ullMismatches[ uxWorker ]++;
+                    break;
+                }
+            }
+
+            ullYield++;
+            ullYields[ uxWorker ] = ullYield;
+        }
+
+        __atomic_add_fetch( &ulWorkersStopped, 1U, __ATOMIC_SEQ_CST );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvRunPhase( const char *pcName, UBaseType_t uxWorkers )
+{
+    uint64_t ullTotal = 0, ullMismatchTotal = 0;
+    UBaseType_t uxWorker;
+
+    for( uxWorker = 0; uxWorker < uxWorkers; uxWorker++ )
+    {
+        ullYields[ uxWorker ] = 0;
+        ullMismatches[ uxWorker ] = 0;
+    }
+
+    ulWorkersStopped = 0;
+
+    #if ( configUSE_PORT_PMU_TRACE == 1 )
+    {
+        vPortPMUResetStats();
+    }
+    #endif
+
+    __atomic_store_n( &ulRunning, 1U, __ATOMIC_SEQ_CST );
+    vTaskDelay( pdMS_TO_TICKS( demoPHASE_TIME_MS ) );
+    __atomic_store_n( &ulRunning, 0U, __ATOMIC_SEQ_CST );
+
+    while( ulWorkersStopped < uxWorkers )
+    {
+        vTaskDelay( 1 );
+    }
+
+    DebugP_log( "%s, %u tasks:\r\n", pcName, ( unsigned ) uxWorkers );
+
+    for( uxWorker = 0; uxWorker < uxWorkers; uxWorker++ )
+    {
+        DebugP_log( "  task %u on core %u: %llu yields, %llu mismatches\r\n", ( unsigned ) uxWorker,
+                    ( unsigned ) ( uxWorker % configNUMBER_OF_CORES ), ( unsigned long long ) ullYields[ uxWorker ],
+                    ( unsigned long long ) ullMismatches[ uxWorker ] );
+        ullTotal += ullYields[ uxWorker ];
+        ullMismatchTotal += ullMismatches[ uxWorker ];
+    }
+
+    DebugP_log( "  %llu yields/s\r\n", ( unsigned long long ) ( ( ullTotal * 1000ULL ) / demoPHASE_TIME_MS ) );
+
+    #if ( configUSE_PORT_PMU_TRACE == 1 )
+    {
+        vPortPMUDumpStats();
+    }
+    #endif
+
+    return ( ullMismatchTotal == 0 ) ? pdTRUE : pdFALSE;
+}
+
+static void prvControlTask( void *pvParameters )
+{
+    UBaseType_t uxWorker;
+    BaseType_t xAllOk;
+
+    ( void ) pvParameters;
+
+    xAllOk = prvRunPhase( "alone", configNUMBER_OF_CORES );
+
+    /* Give every core a second task for the paired phase. */
+    for( uxWorker = configNUMBER_OF_CORES; uxWorker < demoWORKERS; uxWorker++ )
+    {
+        ( void ) xTaskCreateAffinitySet( prvWorkerTask, "Yield", configMINIMAL_STACK_SIZE, ( void * ) uxWorker,
+                                         demoWORKER_PRIORITY,
+                                         ( UBaseType_t ) 1U << ( uxWorker % configNUMBER_OF_CORES ), NULL );
+    }
+
+    if( prvRunPhase( "paired", demoWORKERS ) == pdFALSE )
+    {
+        xAllOk = pdFALSE;
+    }
+
+    DebugP_log( "done\r\n" );
+
+    configASSERT( xAllOk != pdFALSE );
+
+    for( ;; )
+    {
+        vTaskDelay( portMAX_DELAY );
+    }
+}
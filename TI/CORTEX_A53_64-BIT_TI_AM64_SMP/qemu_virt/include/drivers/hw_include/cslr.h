@@ -0,0 +1,85 @@
+/*
+ * FreeRTOS Kernel <DEVELOPMENT BRANCH>
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * GICv3 redistributor register layout used by the A53 port, for the QEMU
+ * virt board layer.  Only the registers the port and the board layer touch
+ * are named.  See README.md.
+ */
+
+#ifndef CSLR_H
+#define CSLR_H
+
+#include <stdint.h>
+
+/* RD_base frame. */
+typedef struct
+{
+    volatile uint32_t CTLR;             /* 0x0000 */
+    volatile uint32_t IIDR;             /* 0x0004 */
+    volatile uint64_t TYPER;            /* 0x0008 */
+    volatile uint32_t STATUSR;          /* 0x0010 */
+    volatile uint32_t WAKER;            /* 0x0014 */
+    volatile uint8_t  RSVD0[ 0x10000 - 0x18 ];
+} CSL_gic500_gicrRegs_core_control;
+
+/* SGI_base frame. */
+typedef struct
+{
+    volatile uint8_t  RSVD0[ 0x80 ];
+    volatile uint32_t IGROUPR0;         /* 0x0080 */
+    volatile uint8_t  RSVD1[ 0x100 - 0x84 ];
+    volatile uint32_t ISENABLER0;       /* 0x0100 */
+    volatile uint8_t  RSVD2[ 0x180 - 0x104 ];
+    volatile uint32_t ICENABLER0;       /* 0x0180 */
+    volatile uint8_t  RSVD3[ 0x200 - 0x184 ];
+    volatile uint32_t ISPENDR0;         /* 0x0200 */
+    volatile uint8_t  RSVD4[ 0x280 - 0x204 ];
+    volatile uint32_t ICPENDR0;         /* 0x0280 */
+    volatile uint8_t  RSVD5[ 0x400 - 0x284 ];
+    volatile uint8_t  IPRIORITYR[ 32 ]; /* 0x0400 */
+    volatile uint8_t  RSVD6[ 0xC00 - 0x420 ];
+    volatile uint32_t ICFGR0;           /* 0x0C00 */
+    volatile uint32_t ICFGR1;           /* 0x0C04 */
+    volatile uint8_t  RSVD7[ 0xD00 - 0xC08 ];
+    volatile uint32_t IGRPMODR0;        /* 0x0D00 */
+    volatile uint8_t  RSVD8[ 0x10000 - 0xD04 ];
+} CSL_gic500_gicrRegs_core_sgi_ppi;
+
+typedef struct
+{
+    CSL_gic500_gicrRegs_core_control CONTROL;
+    CSL_gic500_gicrRegs_core_sgi_ppi SGI_PPI;
+} CSL_gic500_gicrRegs_core;
+
+typedef struct
+{
+    CSL_gic500_gicrRegs_core CORE[ 8 ];
+} CSL_gic500_gicrRegs;
+
+#endif /* CSLR_H */
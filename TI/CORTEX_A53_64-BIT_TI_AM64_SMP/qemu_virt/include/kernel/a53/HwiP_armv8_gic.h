@@ -0,0 +1,62 @@
+/*
+ * FreeRTOS Kernel <DEVELOPMENT BRANCH>
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Subset of the TI A53 GICv3 HwiP definitions used by the A53 port, for the
+ * QEMU virt board layer.  See README.md.
+ */
+
+#ifndef HWIP_ARMV8_GIC_H
+#define HWIP_ARMV8_GIC_H
+
+#include <stdint.h>
+#include <kernel/dpl/HwiP.h>
+#include <kernel/a53/common_armv8.h>
+#include <drivers/hw_include/cslr.h>
+
+#define HWIP_GIC_BASE_ADDR                  ( BOARD_VIRT_GICD_BASE )
+#define HWIP_GICD_SGI_PPI_INTR_ID_MAX       ( 32u )
+
+/* Shared by all cores: SGIs and PPIs are banked in the GIC but have one
+handler each, as on the TI DPL. */
+typedef struct HwiP_Ctrl_s
+{
+    HwiP_FxnCallback isr[ HwiP_MAX_INTERRUPTS ];
+    void *isrArgs[ HwiP_MAX_INTERRUPTS ];
+    uint32_t spuriousIRQCount;
+} HwiP_Ctrl;
+
+extern HwiP_Ctrl gHwiCtrl;
+
+/* Called from HwiP_IRQ_Handler in portASM.S. */
+void HwiP_intrHandler( void );
+
+/* Called from HwiP_defaultExcHandler in portASM.S for unexpected exceptions. */
+void HwiP_defaultHandler( uint64_t elr );
+
+#endif /* HWIP_ARMV8_GIC_H */
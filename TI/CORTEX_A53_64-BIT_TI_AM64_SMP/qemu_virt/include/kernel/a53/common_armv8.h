@@ -0,0 +1,60 @@
+/*
+ * FreeRTOS Kernel <DEVELOPMENT BRANCH>
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Subset of the TI A53 common definitions used by the A53 port, for the QEMU
+ * virt board layer.  See README.md.
+ */
+
+#ifndef COMMON_ARMV8_H
+#define COMMON_ARMV8_H
+
+/* Also included by boot.S. */
+#ifndef __ASSEMBLER__
+    #include <stdint.h>
+#endif
+
+/* Memory map of the QEMU virt machine. */
+#define BOARD_VIRT_GICD_BASE        ( 0x08000000UL )
+#define BOARD_VIRT_GICR_BASE        ( 0x080A0000UL )
+#define BOARD_VIRT_UART_BASE        ( 0x09000000UL )
+
+/* Boot, main and secondary core stacks are set up by boot.S for up to this
+many cores, all in cluster 0 of the virt machine. */
+#define BOARD_VIRT_MAX_CORES        8
+
+/* Per-core stack sizes, can be overridden on the command line. */
+#ifndef BOARD_VIRT_EXC_STACK_SIZE
+    #define BOARD_VIRT_EXC_STACK_SIZE   0x2000
+#endif
+
+#ifndef BOARD_VIRT_MAIN_STACK_SIZE
+    #define BOARD_VIRT_MAIN_STACK_SIZE  0x4000
+#endif
+
+#endif /* COMMON_ARMV8_H */
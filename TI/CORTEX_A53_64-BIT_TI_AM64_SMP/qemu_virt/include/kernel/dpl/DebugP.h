@@ -0,0 +1,52 @@
+/*
+ * FreeRTOS Kernel <DEVELOPMENT BRANCH>
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Subset of the TI DPL DebugP interface used by the A53 port, for the QEMU
+ * virt board layer.  Output goes to the PL011 UART.  See README.md.
+ */
+
+#ifndef DEBUGP_H
+#define DEBUGP_H
+
+#include <stdint.h>
+
+/* printf() style output to the UART.  Lines from different cores are not
+interleaved. */
+void DebugP_log( const char *format, ... ) __attribute__( ( format( printf, 1, 2 ) ) );
+
+#define DebugP_logError( format, ... )  DebugP_log( "ERROR: " format "\r\n", ##__VA_ARGS__ )
+
+/* Stop the calling core, with IRQs masked, if expression is false. */
+void _DebugP_assertNoLog( int32_t expression );
+void _DebugP_assert( int32_t expression, const char *file, const char *function, int32_t line, const char *expressionString );
+
+#define DebugP_assertNoLog( expression )    _DebugP_assertNoLog( ( int32_t ) ( expression ) )
+#define DebugP_assert( expression )         _DebugP_assert( ( int32_t ) ( expression ), __FILE__, __FUNCTION__, __LINE__, #expression )
+
+#endif /* DEBUGP_H */
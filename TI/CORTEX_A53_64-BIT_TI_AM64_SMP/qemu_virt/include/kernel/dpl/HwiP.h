@@ -0,0 +1,86 @@
+/*
+ * FreeRTOS Kernel <DEVELOPMENT BRANCH>
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Subset of the TI DPL HwiP interface used by the A53 port, for the QEMU
+ * virt board layer.  Interrupts are routed through the GICv3 of the virt
+ * machine.  See README.md.
+ */
+
+#ifndef HWIP_H
+#define HWIP_H
+
+#include <stdint.h>
+#include <kernel/dpl/SystemP.h>
+#include <kernel/dpl/DebugP.h>
+
+/* 16 SGIs, 16 PPIs and the 256 SPIs of the virt machine. */
+#define HwiP_MAX_INTERRUPTS     ( 288u )
+
+/* Lowest GIC priority that is still below the unmasked ICC_PMR_EL1 value. */
+#define HwiP_MAX_PRIORITY       ( 16u )
+
+typedef void ( *HwiP_FxnCallback )( void *args );
+
+typedef struct HwiP_Params_s
+{
+    uint32_t intNum;            /* GIC INTID. */
+    HwiP_FxnCallback callback;
+    void *args;
+    uint8_t priority;           /* 0 (highest) to HwiP_MAX_PRIORITY - 1. */
+    uint8_t isPulse;            /* 1 for edge triggered, 0 for level. */
+} HwiP_Params;
+
+typedef struct HwiP_Object_s
+{
+    uint32_t intNum;
+} HwiP_Object;
+
+void HwiP_Params_init( HwiP_Params *params );
+
+/* Install params->callback for params->intNum and enable the interrupt.  An
+SGI or PPI is enabled on the calling core only, an SPI is routed to the
+calling core. */
+int32_t HwiP_construct( HwiP_Object *obj, HwiP_Params *params );
+void HwiP_destruct( HwiP_Object *obj );
+
+void HwiP_enableInt( uint32_t intNum );
+uint32_t HwiP_disableInt( uint32_t intNum );
+void HwiP_restoreInt( uint32_t intNum, uint32_t oldIntState );
+void HwiP_clearInt( uint32_t intNum );
+void HwiP_post( uint32_t intNum );
+
+/* Mask IRQs at the CPU, returning the previous DAIF to pass to HwiP_restore(). */
+uintptr_t HwiP_disable( void );
+void HwiP_enable( void );
+void HwiP_restore( uintptr_t oldIntState );
+
+/* Non-zero when called from an exception handler. */
+uint32_t HwiP_inISR( void );
+
+#endif /* HWIP_H */
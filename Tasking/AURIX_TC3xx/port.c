@@ -84,11 +84,35 @@ static inline void __attribute__( ( always_inline ) ) vPortSaveContext( unsigned
 
 static inline uint32_t * __attribute__( ( always_inline ) ) pxPortCsaToAddress( uint32_t xCsa );
 
+static void prvTaskExitError( void );
+
 static UBaseType_t uxCriticalNesting = 0xaaaaaaaa;
 
+/* Link word of the CSA at the bottom of the running task's call stack. It is
+ * kept in the task's saved context next to uxCriticalNesting so
+ * vPortReclaimCSA() can find the tail of the chain without walking it. */
+static uint32_t ulTailCSA = 0;
+
+#if ( configUSE_PORT_CSA_ACCOUNTING != 0 )
+
+/* Lowest number of free CSAs seen by any exact sample of the free list. */
+    static UBaseType_t uxMinimumEverFreeCSACount = ~( ( UBaseType_t ) 0 );
+
+/* Set while the free list is below configPORT_CSA_LOW_THRESHOLD, so the hook
+ * is called once per crossing. */
+    static BaseType_t xCSALowReported = pdFALSE;
+
+    static UBaseType_t prvSampleFreeCSAs( UBaseType_t uxLimit );
+#endif
+
 /* FreeRTOS required functions */
 BaseType_t xPortStartScheduler( void )
 {
+    #if ( configUSE_PORT_CSA_ACCOUNTING != 0 )
+        /* Take the first exact sample of the free list. */
+        ( void ) uxPortGetFreeCSACount();
+    #endif
+
     vPortInitTickTimer();
     vPortInitContextSrc();
     vPortStartFirstTask();
@@ -106,9 +130,14 @@ StackType_t *pxPortInitialiseStack( StackType_t * pxTopOfStack,
                                     TaskFunction_t pxCode,
                                     void * pvParameters )
 {
-    uint32_t xLowerCsa = 0, xUpperCsa = 0;
+    uint32_t xLowerCsa = 0, xUpperCsa = 0, xTailCsa = 0;
     uint32_t * pxUpperCSA = NULL;
     uint32_t * pxLowerCSA = NULL;
+    uint32_t * pxTailCSA = NULL;
+
+    #if ( configUSE_PORT_CSA_ACCOUNTING != 0 )
+        UBaseType_t uxFreeCSAs = 0;
+    #endif
 
     /* Have to disable interrupts here because the CSAs are going to be
      * manipulated. */
@@ -117,36 +146,67 @@ StackType_t *pxPortInitialiseStack( StackType_t * pxTopOfStack,
         /* DSync to ensure that buffering is not a problem. */
         __dsync();
 
-        /* Consume two free CSAs. */
+        /* Consume three free CSAs. Links on the free list may still carry
+         * PCXI status bits from a reclaimed call stack, only the address is
+         * used. */
         xLowerCsa = __mfcr( portCPU_FCX );
         pxLowerCSA = pxPortCsaToAddress( xLowerCsa );
 
         if( pxLowerCSA != NULL )
         {
             /* The Lower Links to the Upper. */
-            xUpperCsa = pxLowerCSA[ 0 ];
-            pxUpperCSA = pxPortCsaToAddress( pxLowerCSA[ 0 ] );
+            xUpperCsa = pxLowerCSA[ 0 ] & portCSA_FCX_MASK;
+            pxUpperCSA = pxPortCsaToAddress( xUpperCsa );
+        }
+
+        if( pxUpperCSA != NULL )
+        {
+            /* The Upper Links to the Tail. */
+            xTailCsa = pxUpperCSA[ 0 ] & portCSA_FCX_MASK;
+            pxTailCSA = pxPortCsaToAddress( xTailCsa );
         }
 
-        /* Check that we have successfully reserved two CSAs. */
-        if( ( pxLowerCSA != NULL ) && ( pxUpperCSA != NULL ) )
+        /* Check that we have successfully reserved three CSAs. */
+        if( pxTailCSA != NULL )
         {
-            /* Remove the two consumed CSAs from the free CSA list. */
-            __mtcr( portCPU_FCX, pxUpperCSA[ 0 ] );
+            /* Remove the three consumed CSAs from the free CSA list. */
+            __mtcr( portCPU_FCX, pxTailCSA[ 0 ] & portCSA_FCX_MASK );
         }
         else
         {
             /* Simply trigger a context list depletion trap. */
             __asm( "\tsvlcx" );
         }
+
+        #if ( configUSE_PORT_CSA_ACCOUNTING != 0 )
+            /* Only walk as far as the checks need. */
+            uxFreeCSAs = prvSampleFreeCSAs( configPORT_CSA_TASK_BUDGET + configPORT_CSA_LOW_THRESHOLD );
+        #endif
     }
     __enable();
 
+    #if ( configUSE_PORT_CSA_ACCOUNTING != 0 )
+        /* The CSAs left after this task's three must cover the budget the
+         * task is expected to use for its call stack. */
+        configASSERT( uxFreeCSAs >= configPORT_CSA_TASK_BUDGET );
+    #endif
+
+    /* Tail. It terminates the task's call stack. Every CSA the task consumes
+     * later is linked above it, so it stays the bottom of the chain for the
+     * life of the task. It is only restored if the task function returns,
+     * which enters prvTaskExitError() on the task's stack. Its own PCXI is 0,
+     * so returning from there raises the context list underflow trap. */
+    memset( pxTailCSA, 0, portNUM_WORDS_IN_CSA * sizeof( uint32_t ) );
+    pxTailCSA[ 3 ] = ( uint32_t ) prvTaskExitError; /* A11;    Return Address aka RA */
+    pxTailCSA[ 2 ] = ( uint32_t ) pxTopOfStack;     /* A10;    Stack Return aka Stack Pointer */
+    pxTailCSA[ 1 ] = portINITIAL_SYSTEM_PSW;        /* PSW    */
+
     /* Upper Context. */
     memset( pxUpperCSA, 0, portNUM_WORDS_IN_CSA * sizeof( uint32_t ) );
+    pxUpperCSA[ 3 ] = ( uint32_t ) prvTaskExitError; /* A11;    Return Address of the task function */
     pxUpperCSA[ 2 ] = ( uint32_t ) pxTopOfStack; /* A10;    Stack Return aka Stack Pointer */
     pxUpperCSA[ 1 ] = portINITIAL_SYSTEM_PSW;    /* PSW    */
-    pxUpperCSA[ 0 ] = portINITIAL_UPPER_PCXI;
+    pxUpperCSA[ 0 ] = portINITIAL_UPPER_PCXI | xTailCsa; /* PCXI pointing to the Tail. */
 
     /* Lower Context. */
     memset( pxLowerCSA, 0, portNUM_WORDS_IN_CSA * sizeof( uint32_t ) );
@@ -154,6 +214,9 @@ StackType_t *pxPortInitialiseStack( StackType_t * pxTopOfStack,
     pxLowerCSA[ 1 ] = ( uint32_t ) pxCode;                /* A11;    Return Address aka RA */
     pxLowerCSA[ 0 ] = portINITIAL_LOWER_PCXI | xUpperCsa; /* PCXI pointing to the Upper context. */
 
+    /* Save the link to the tail of the call stack. */
+    pxTopOfStack--;
+    *pxTopOfStack = xTailCsa;
     /* Initialize the uxCriticalNesting. */
     pxTopOfStack--;
     *pxTopOfStack = 0;
@@ -200,6 +263,11 @@ vPortSystemTickHandler()
     /* Kernel API calls require Critical Sections. */
     ulSavedInterruptMask = portSET_INTERRUPT_MASK_FROM_ISR();
     {
+        #if ( configUSE_PORT_CSA_ACCOUNTING != 0 ) && ( configPORT_CSA_LOW_THRESHOLD > 0 )
+            /* Bounded sample of the free list for the early warning. */
+            ( void ) prvSampleFreeCSAs( configPORT_CSA_LOW_THRESHOLD );
+        #endif
+
         /* Increment the Tick. */
         xYieldRequired = xTaskIncrementTick();
     }
@@ -291,6 +359,8 @@ void vPortLoadContext( unsigned char ucCallDepth )
     ( *ppxTopOfStack )++;
     uxCriticalNesting = **ppxTopOfStack;
     ( *ppxTopOfStack )++;
+    ulTailCSA = **ppxTopOfStack;
+    ( *ppxTopOfStack )++;
 
     /* Store the lower context directly if inside the syscall or interrupt,
      * else replace the lower context in the call stack. */
@@ -348,6 +418,9 @@ void vPortSaveContext( unsigned char ucCallDepth )
     ppxTopOfStack = ( uint32_t ** ) pxCurrentTCB;
     /* Update the stack info in the TCB */
     *ppxTopOfStack = ( uint32_t * ) pxUpperCSA[ 2 ];
+    /* Place the tail CSA id */
+    ( *ppxTopOfStack )--;
+    **ppxTopOfStack = ulTailCSA;
     /* Place ucNestedContext */
     ( *ppxTopOfStack )--;
     **ppxTopOfStack = uxCriticalNesting;
@@ -409,9 +482,13 @@ void vPortExitCritical( void )
  * they are not part of the current Call Stack, hence, delaying the
  * reclamation until the IDLE task is freeing the task's other resources.
  * This function uses the head of the linked list of CSAs (from when the
- * task yielded for the last time) and finds the tail (the very bottom of
- * the call stack) and inserts this list at the head of the Free list,
- * attaching the existing Free List to the tail of the reclaimed call stack.
+ * task yielded for the last time) and the tail (the very bottom of the call
+ * stack, allocated in pxPortInitialiseStack() and saved with the task's
+ * context) and inserts this list at the head of the Free list, attaching the
+ * existing Free List to the tail of the reclaimed call stack. The cost does
+ * not depend on the depth of the call stack. The links inside the list keep
+ * their PCXI status bits; only bits 19:0 of a free CSA's link are used when
+ * the CSA is allocated again.
  *
  * NOTE: In highly loaded systems the release of used CSAs might be delayed,
  * since it is executed es part of the calling tasks, if the deleted task is
@@ -421,21 +498,15 @@ void vPortExitCritical( void )
 void vPortReclaimCSA( unsigned long ** pxTCB )
 {
     uint32_t ulHeadCSA, ulFreeCSA;
-    uint32_t * pulNextCSA;
+    uint32_t * pulTailCSA;
 
     /* The lower context (PCXI value) to return to the task is stored as the
      * current element on the stack. Mask off everything in the PCXI register
      * other than the address. */
     ulHeadCSA = ( **pxTCB ) & portCSA_FCX_MASK;
 
-    /* Iterate over the CSAs that were consumed as part of the task. */
-    for(pulNextCSA = pxPortCsaToAddress( ulHeadCSA );
-        ( pulNextCSA[ 0 ] & portCSA_FCX_MASK ) != 0;
-        pulNextCSA = pxPortCsaToAddress( pulNextCSA[ 0 ] ) )
-    {
-        /* Mask off everything in the PCXI value other than the address. */
-        pulNextCSA[ 0 ] &= portCSA_FCX_MASK;
-    }
+    /* The tail is stored after uxCriticalNesting. */
+    pulTailCSA = pxPortCsaToAddress( ( *pxTCB )[ 2 ] );
 
     __disable();
     {
@@ -444,7 +515,7 @@ void vPortReclaimCSA( unsigned long ** pxTCB )
         ulFreeCSA = __mfcr( portCPU_FCX );
 
         /* Join the current free onto the tail of what is being reclaimed. */
-        pulNextCSA[ 0 ] = ulFreeCSA;
+        pulTailCSA[ 0 ] = ulFreeCSA;
 
         /* Move the head of the reclaimed into the Free. */
         __mtcr( portCPU_FCX, ulHeadCSA );
@@ -452,9 +523,134 @@ void vPortReclaimCSA( unsigned long ** pxTCB )
     __enable();
 }
 
+#if ( configUSE_PORT_CSA_ACCOUNTING != 0 )
+
+/*
+ * Counts the CSAs that can still be consumed before FCX reaches LCX and the
+ * free context list depletion trap is taken, stopping at uxLimit. A count
+ * below uxLimit is exact and updates the minimum ever free count. Each time
+ * the count drops below configPORT_CSA_LOW_THRESHOLD, vApplicationCSALowHook()
+ * is called once, from here.
+ *
+ * Must be called with interrupts disabled, or from the tick with the mask
+ * raised to configMAX_API_CALL_INTERRUPT_PRIORITY. An interrupt above the mask
+ * takes CSAs from the head of the list but returns them in the same order
+ * before the walk resumes, and never calls this function, so the list and the
+ * state updated here are not changed under it.
+ */
+    static UBaseType_t prvSampleFreeCSAs( UBaseType_t uxLimit )
+    {
+        uint32_t ulCSA, ulLimitCSA;
+        UBaseType_t uxCount = 0;
+
+        __dsync();
+        ulCSA = __mfcr( portCPU_FCX ) & portCSA_FCX_MASK;
+        ulLimitCSA = __mfcr( portCPU_LCX ) & portCSA_FCX_MASK;
+
+        while( ( ulCSA != 0 ) && ( ulCSA != ulLimitCSA ) && ( uxCount < uxLimit ) )
+        {
+            uxCount++;
+            ulCSA = pxPortCsaToAddress( ulCSA )[ 0 ] & portCSA_FCX_MASK;
+        }
+
+        if( ( uxCount < uxLimit ) && ( uxCount < uxMinimumEverFreeCSACount ) )
+        {
+            uxMinimumEverFreeCSACount = uxCount;
+        }
+
+        #if ( configPORT_CSA_LOW_THRESHOLD > 0 )
+            if( uxCount < configPORT_CSA_LOW_THRESHOLD )
+            {
+                if( xCSALowReported == pdFALSE )
+                {
+                    xCSALowReported = pdTRUE;
+                    vApplicationCSALowHook( uxCount );
+                }
+            }
+            else
+            {
+                xCSALowReported = pdFALSE;
+            }
+        #endif
+
+        return uxCount;
+    }
+
+    UBaseType_t uxPortGetFreeCSACount( void )
+    {
+        UBaseType_t uxFreeCSAs;
+
+        __disable();
+        {
+            uxFreeCSAs = prvSampleFreeCSAs( ~( ( UBaseType_t ) 0 ) );
+        }
+        __enable();
+
+        return uxFreeCSAs;
+    }
+
+    UBaseType_t uxPortGetMinimumEverFreeCSACount( void )
+    {
+        return uxMinimumEverFreeCSACount;
+    }
+
+/*
+ * Counts the CSAs held by a task, from the head of its call stack down to and
+ * including the tail allocated in pxPortInitialiseStack(). For the calling
+ * task the head is PCXI, for any other task it is the lower context saved on
+ * its stack.
+ */
+    UBaseType_t uxPortGetTaskCSACount( void * xTask )
+    {
+        uint32_t ulCSA, ulTaskTailCSA;
+        UBaseType_t uxCount = 0;
+
+        __disable();
+        {
+            __dsync();
+
+            if( ( xTask == NULL ) || ( xTask == ( void * ) pxCurrentTCB ) )
+            {
+                ulCSA = __mfcr( portCPU_PCXI ) & portCSA_FCX_MASK;
+                ulTaskTailCSA = ulTailCSA & portCSA_FCX_MASK;
+            }
+            else
+            {
+                ulCSA = ( *( uint32_t ** ) xTask )[ 0 ] & portCSA_FCX_MASK;
+                ulTaskTailCSA = ( *( uint32_t ** ) xTask )[ 2 ] & portCSA_FCX_MASK;
+            }
+
+            while( ulCSA != 0 )
+            {
+                uxCount++;
+
+                if( ulCSA == ulTaskTailCSA )
+                {
+                    break;
+                }
+
+                ulCSA = pxPortCsaToAddress( ulCSA )[ 0 ] & portCSA_FCX_MASK;
+            }
+        }
+        __enable();
+
+        return uxCount;
+    }
+
+#endif /* configUSE_PORT_CSA_ACCOUNTING */
+
 void __attribute__( ( noreturn ) ) vPortLoopForever( void )
 {
     while( 1 )
     {
     }
 }
+
+static void prvTaskExitError( void )
+{
+    /* A task function must not return. It must delete itself with
+     * vTaskDelete( NULL ) instead. */
+    configASSERT( 0 );
+    __disable();
+    vPortLoopForever();
+}